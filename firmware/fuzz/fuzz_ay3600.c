@@ -0,0 +1,335 @@
+/**
+ * @file fuzz_ay3600.c
+ * @brief Coverage-guided fuzz target for the AY-3600 emulator
+ *
+ * Decodes the input into a configuration and a sequence of key events,
+ * resets and virtual-time advances, runs it against the emulator and
+ * checks every output update against a reference model of the waveform.
+ * Any divergence aborts with a description of the failing step.
+ *
+ * Input format:
+ *
+ *     byte 0   debounce_ms (low 6 bits)
+ *     byte 1   repeat_delay_ms
+ *     byte 2   repeat_rate_ms (low 7 bits, 0 disables repeat)
+ *     then one operation per byte, top two bits select it:
+ *       00cccccc  press key c (codes above 31 are invalid), next byte
+ *                 bit 0 CONTROL, bit 1 SHIFT
+ *       01cccccc  release key c
+ *       10tttttt  advance time by t ms
+ *       11tttttt  reset if t == 0, else advance time by 8 * t ms
+ *
+ * The emulator reads a virtual clock. Time advances jump straight to each
+ * pending deadline and call ay3600_process() there, which is exactly what
+ * a 1 ms main loop would observe, without stepping through idle ticks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ay3600_emulator.h"
+
+#define FUZZ_CONFIG_BYTES   3
+#define MAX_UPDATES         4096
+
+/**
+ * @brief Output update with the virtual time it happened at
+ */
+typedef struct {
+    uint32_t time;
+    ay3600_output_t output;
+} update_t;
+
+/**
+ * @brief Reference model of the encoder
+ *
+ * Written from the behavior description, not from the emulator: a held
+ * key strobes once after debounce (immediately without debounce), then
+ * after the repeat delay, then every repeat period. Intervals of zero take
+ * effect on the next millisecond. A release only applies to the held key.
+ */
+typedef struct {
+    uint16_t debounce_ms;
+    uint16_t repeat_delay_ms;
+    uint16_t repeat_rate_ms;
+
+    bool held;                 /**< A key is down (debouncing or pressed) */
+    uint8_t key;
+    bool control;
+    bool shift;
+    uint32_t strobes;          /**< Strobes produced for the held key */
+    bool strobe_pending;       /**< next_strobe is valid */
+    uint32_t next_strobe;      /**< Time of the next strobe */
+
+    ay3600_output_t output;    /**< Expected output lines */
+    uint32_t keypresses;
+    uint32_t repeats;
+    uint32_t debounce_events;
+} model_t;
+
+static uint32_t virtual_now;
+static update_t actual[MAX_UPDATES];
+static size_t actual_count;
+static update_t expected[MAX_UPDATES];
+static size_t expected_count;
+static size_t op_index;
+
+static uint32_t virtual_clock(void)
+{
+    return virtual_now;
+}
+
+static void record_actual(const ay3600_output_t *output)
+{
+    if (actual_count < MAX_UPDATES) {
+        actual[actual_count].time = virtual_now;
+        actual[actual_count].output = *output;
+    }
+    actual_count++;
+}
+
+static void model_emit(model_t *model, uint32_t time)
+{
+    if (expected_count < MAX_UPDATES) {
+        expected[expected_count].time = time;
+        expected[expected_count].output = model->output;
+    }
+    expected_count++;
+}
+
+static uint32_t at_least_one(uint32_t interval)
+{
+    return interval ? interval : 1;
+}
+
+static void model_strobe(model_t *model, uint32_t time)
+{
+    model->output.key_code = model->key;
+    model->output.control = model->control;
+    model->output.shift = model->shift;
+    model->output.any_key = true;
+    model->output.strobe = true;
+    model_emit(model, time);
+    model->output.strobe = false;
+
+    if (model->strobes == 0) {
+        model->keypresses++;
+    } else {
+        model->repeats++;
+    }
+    model->strobes++;
+
+    model->strobe_pending = model->repeat_rate_ms != 0;
+    model->next_strobe = time + at_least_one(model->strobes == 1 ? model->repeat_delay_ms
+                                                                 : model->repeat_rate_ms);
+}
+
+static void model_clear(model_t *model, uint32_t time)
+{
+    memset(&model->output, 0, sizeof(model->output));
+    model->held = false;
+    model->strobe_pending = false;
+    model_emit(model, time);
+}
+
+static void model_advance(model_t *model, uint32_t target)
+{
+    while (model->strobe_pending && (int32_t)(model->next_strobe - target) <= 0) {
+        model_strobe(model, model->next_strobe);
+    }
+}
+
+static int model_press(model_t *model, uint8_t key, bool control, bool shift, uint32_t now)
+{
+    if (key > AY3600_MAX_KEY_CODE) {
+        return -1;
+    }
+
+    model->held = true;
+    model->key = key;
+    model->control = control;
+    model->shift = shift;
+    model->strobes = 0;
+
+    if (model->debounce_ms == 0) {
+        model_strobe(model, now);
+    } else {
+        model->debounce_events++;
+        model->strobe_pending = true;
+        model->next_strobe = now + model->debounce_ms;
+    }
+    return 0;
+}
+
+static void model_release(model_t *model, uint8_t key, uint32_t now)
+{
+    if (model->held && key != model->key) {
+        return;
+    }
+    model_clear(model, now);
+}
+
+static void print_update(const char *label, const update_t *update)
+{
+    fprintf(stderr, "  %s t=%lu code=%02X c=%d s=%d any=%d strobe=%d\n", label,
+            (unsigned long)update->time, update->output.key_code, update->output.control,
+            update->output.shift, update->output.any_key, update->output.strobe);
+}
+
+static void fail(const char *what, size_t index)
+{
+    fprintf(stderr, "fuzz_ay3600: %s at input byte %zu (update %zu)\n", what, op_index, index);
+    if (index < actual_count && index < MAX_UPDATES) {
+        print_update("actual:  ", &actual[index]);
+    }
+    if (index < expected_count && index < MAX_UPDATES) {
+        print_update("expected:", &expected[index]);
+    }
+    abort();
+}
+
+static void compare_updates(void)
+{
+    if (actual_count != expected_count) {
+        size_t n = actual_count < expected_count ? actual_count : expected_count;
+        fprintf(stderr, "fuzz_ay3600: %zu updates, expected %zu\n", actual_count, expected_count);
+        fail("update count mismatch", n);
+    }
+
+    for (size_t i = 0; i < actual_count && i < MAX_UPDATES; i++) {
+        const update_t *a = &actual[i];
+        const update_t *e = &expected[i];
+        if (a->time != e->time || a->output.key_code != e->output.key_code ||
+            a->output.control != e->output.control || a->output.shift != e->output.shift ||
+            a->output.any_key != e->output.any_key || a->output.strobe != e->output.strobe) {
+            fail("output mismatch", i);
+        }
+    }
+
+    actual_count = 0;
+    expected_count = 0;
+}
+
+/**
+ * @brief Advance virtual time, stopping at every emulator deadline
+ */
+static void advance(model_t *model, uint32_t ms)
+{
+    uint32_t target = virtual_now + ms;
+    uint32_t deadline;
+
+    while (ay3600_next_deadline(&deadline) == 0 && (int32_t)(deadline - target) <= 0) {
+        virtual_now = deadline;
+        ay3600_process();
+    }
+    virtual_now = target;
+    ay3600_process();
+
+    model_advance(model, target);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    model_t model;
+    ay3600_output_t output;
+    ay3600_stats_t stats;
+
+    if (size < FUZZ_CONFIG_BYTES) {
+        return 0;
+    }
+
+    ay3600_config_t config = {
+        .output_callback = record_actual,
+        .debounce_ms = data[0] & 0x3F,
+        .repeat_delay_ms = data[1],
+        .repeat_rate_ms = data[2] & 0x7F,
+        .clock_ms = virtual_clock,
+    };
+
+    memset(&model, 0, sizeof(model));
+    model.debounce_ms = config.debounce_ms;
+    model.repeat_delay_ms = config.repeat_delay_ms;
+    model.repeat_rate_ms = config.repeat_rate_ms;
+
+    // Start near the 32-bit wrap so every run crosses it
+    virtual_now = 0xFFFFF000UL + data[1] * 16;
+    actual_count = 0;
+    expected_count = 0;
+    if (ay3600_init(&config) != 0) {
+        abort();
+    }
+
+    for (size_t i = FUZZ_CONFIG_BYTES; i < size; i++) {
+        uint8_t op = data[i] >> 6;
+        uint8_t arg = data[i] & 0x3F;
+
+        op_index = i;
+        switch (op) {
+            case 0: {
+                uint8_t mods = (i + 1 < size) ? data[++i] : 0;
+                ay3600_key_event_t event = {
+                    .key_code = arg,
+                    .control = (mods & 0x01) != 0,
+                    .shift = (mods & 0x02) != 0,
+                    .pressed = true,
+                };
+                int result = ay3600_handle_event(&event);
+                if (result != model_press(&model, arg, event.control, event.shift, virtual_now)) {
+                    fail("press result mismatch", 0);
+                }
+                break;
+            }
+
+            case 1: {
+                ay3600_key_event_t event = {
+                    .key_code = arg,
+                    .pressed = false,
+                };
+                if (ay3600_handle_event(&event) != 0) {
+                    fail("release failed", 0);
+                }
+                model_release(&model, arg, virtual_now);
+                break;
+            }
+
+            case 2:
+                advance(&model, arg);
+                break;
+
+            default:
+                if (arg == 0) {
+                    ay3600_reset();
+                    model_clear(&model, virtual_now);
+                } else {
+                    advance(&model, (uint32_t)arg * 8);
+                }
+                break;
+        }
+
+        compare_updates();
+    }
+
+    // Let any pending repeat play out once more, then check the final state
+    advance(&model, 300);
+    compare_updates();
+
+    ay3600_get_output(&output);
+    if (output.key_code != model.output.key_code || output.control != model.output.control ||
+        output.shift != model.output.shift || output.any_key != model.output.any_key ||
+        output.strobe) {
+        fail("final output mismatch", MAX_UPDATES);
+    }
+
+    ay3600_get_stats(&stats);
+    if (stats.total_keypresses != model.keypresses || stats.total_repeats != model.repeats ||
+        stats.debounce_events != model.debounce_events) {
+        fprintf(stderr, "fuzz_ay3600: stats %lu/%lu/%lu, expected %lu/%lu/%lu\n",
+                (unsigned long)stats.total_keypresses, (unsigned long)stats.total_repeats,
+                (unsigned long)stats.debounce_events, (unsigned long)model.keypresses,
+                (unsigned long)model.repeats, (unsigned long)model.debounce_events);
+        fail("statistics mismatch", MAX_UPDATES);
+    }
+
+    return 0;
+}
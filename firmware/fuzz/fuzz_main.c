@@ -0,0 +1,96 @@
+/**
+ * @file fuzz_main.c
+ * @brief Standalone driver for the fuzz targets
+ *
+ * Lets the libFuzzer targets run without libFuzzer:
+ *
+ *     fuzz_ay3600 FILE...          replay inputs (crash reproduction)
+ *     fuzz_ay3600 < FILE           one input from stdin (AFL)
+ *     fuzz_ay3600 -r N [-s SEED]   N random inputs, reports executions/s
+ *
+ * With AFL++ in persistent mode (afl-clang-fast) stdin inputs are run in a
+ * __AFL_LOOP instead of one process per input.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_INPUT 4096
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static uint8_t input[MAX_INPUT];
+
+static size_t read_input(FILE *file)
+{
+    return fread(input, 1, sizeof(input), file);
+}
+
+static uint64_t xorshift(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static int run_random(unsigned long count, uint64_t seed)
+{
+    struct timespec start, end;
+    uint64_t state = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    uint64_t bytes = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long n = 0; n < count; n++) {
+        size_t size = 3 + xorshift(&state) % 125;
+        for (size_t i = 0; i < size; i++) {
+            input[i] = (uint8_t)xorshift(&state);
+        }
+        bytes += size;
+        LLVMFuzzerTestOneInput(input, size);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%lu executions in %.2f s: %.0f exec/s (avg %.0f bytes)\n",
+           count, seconds, count / seconds, count ? (double)bytes / count : 0.0);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "-r") == 0) {
+        unsigned long count = argc > 2 ? strtoul(argv[2], NULL, 0) : 1000000;
+        uint64_t seed = (argc > 4 && strcmp(argv[3], "-s") == 0) ?
+                        strtoull(argv[4], NULL, 0) : (uint64_t)time(NULL);
+        printf("seed %llu\n", (unsigned long long)seed);
+        return run_random(count, seed);
+    }
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            FILE *file = fopen(argv[i], "rb");
+            if (!file) {
+                perror(argv[i]);
+                return 1;
+            }
+            size_t size = read_input(file);
+            fclose(file);
+            LLVMFuzzerTestOneInput(input, size);
+        }
+        return 0;
+    }
+
+#ifdef __AFL_LOOP
+    while (__AFL_LOOP(100000)) {
+        LLVMFuzzerTestOneInput(input, read_input(stdin));
+    }
+#else
+    LLVMFuzzerTestOneInput(input, read_input(stdin));
+#endif
+    return 0;
+}
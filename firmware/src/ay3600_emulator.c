@@ -4,18 +4,24 @@
  */
 
 #include "ay3600_emulator.h"
+#include "ay3600_output.h"
+#include "ay3600_timer_wheel.h"
+#include "crc32.h"
+#include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 
 #ifndef NATIVE_TEST
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #define LOG_TAG "ay3600"
 #define LOG_DEBUG(fmt, ...) ESP_LOGD(LOG_TAG, fmt, ##__VA_ARGS__)
 #define LOG_INFO(fmt, ...)  ESP_LOGI(LOG_TAG, fmt, ##__VA_ARGS__)
 #define GET_TIME_MS()       (xTaskGetTickCount() * portTICK_PERIOD_MS)
+#define GET_TIME_US()       ((uint64_t)esp_timer_get_time())
 #else
-#include <stdio.h>
 #include <time.h>
 #define LOG_DEBUG(fmt, ...) printf("[DEBUG] " fmt "\n", ##__VA_ARGS__)
 #define LOG_INFO(fmt, ...)  printf("[INFO] " fmt "\n", ##__VA_ARGS__)
@@ -24,7 +30,21 @@ static uint32_t get_time_ms(void) {
     clock_gettime(CLOCK_MONOTONIC, &ts);
     return (ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
 }
+static uint64_t get_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
 #define GET_TIME_MS() get_time_ms()
+#define GET_TIME_US() get_time_us()
+#endif
+
+#ifdef AY3600_NO_LOG
+// Silence logging for simulation and fuzzing throughput
+#undef LOG_DEBUG
+#undef LOG_INFO
+#define LOG_DEBUG(fmt, ...) do { } while (0)
+#define LOG_INFO(fmt, ...)  do { } while (0)
 #endif
 
 /**
@@ -38,6 +58,22 @@ typedef enum {
     STATE_REPEATING,      /**< Key is auto-repeating */
 } ay3600_state_t;
 
+/**
+ * @brief Timer wheel slots used by the emulator
+ */
+enum {
+    TIMER_KEY,            /**< Debounce / repeat deadline for the held key */
+};
+
+/**
+ * @brief Registered output sink
+ */
+typedef struct {
+    ay3600_sink_fn_t fn;             /**< Sink function */
+    uint16_t pin_mask;               /**< Pins of interest */
+    void *ctx;                       /**< Sink context */
+} ay3600_sink_t;
+
 /**
  * @brief Internal emulator state
  */
@@ -51,20 +87,61 @@ typedef struct {
     bool current_control;            /**< Current control state */
     bool current_shift;              /**< Current shift state */
 
-    uint32_t last_change_time;       /**< Time of last state change */
-    uint32_t last_repeat_time;       /**< Time of last repeat */
+    uint32_t now;                    /**< Time of the current operation */
+    ay3600_timer_wheel_t timers;     /**< Debounce and repeat deadlines */
+    ay3600_loop_monitor_t loop;      /**< ay3600_process() call timing */
+
+    bool resume_pending;             /**< Restored key awaits confirmation */
+    bool resume_has_deadline;        /**< resume_deadline is valid */
+    uint32_t resume_deadline;        /**< Key deadline to continue with once confirmed */
+
+    uint16_t levels;                 /**< Pin levels of the last update */
+    ay3600_sink_t sinks[AY3600_MAX_SINKS]; /**< Registered output sinks */
+    uint8_t sink_count;              /**< Number of registered sinks */
 } ay3600_state_internal_t;
 
 static ay3600_state_internal_t g_state;
 
+/**
+ * @brief Current time from the configured clock, or the system tick
+ */
+static uint32_t now_ms(void)
+{
+    return g_state.config.clock_ms ? g_state.config.clock_ms() : GET_TIME_MS();
+}
+
+/**
+ * @brief Microsecond time for the loop monitor
+ */
+static uint64_t now_us(void)
+{
+    return g_state.config.clock_ms ? (uint64_t)g_state.config.clock_ms() * 1000 : GET_TIME_US();
+}
+
 /**
  * @brief Update output signals and call callback
  */
 static void update_output(void)
 {
+    uint16_t levels = ay3600_output_levels(&g_state.output);
+    uint16_t changed = levels ^ g_state.levels;
+
+    if (g_state.output.strobe) {
+        changed |= AY3600_PIN_BIT(AY3600_PIN_KSTRB);
+    }
+    g_state.levels = levels;
+
+    // Hardware output first so sinks cannot delay it
     if (g_state.config.output_callback) {
         g_state.config.output_callback(&g_state.output);
     }
+
+    for (uint8_t i = 0; i < g_state.sink_count; i++) {
+        const ay3600_sink_t *sink = &g_state.sinks[i];
+        if (changed & sink->pin_mask) {
+            sink->fn(&g_state.output, changed, sink->ctx);
+        }
+    }
 }
 
 /**
@@ -103,6 +180,68 @@ static void clear_output(void)
     update_output();
 }
 
+/**
+ * @brief Schedule the next auto-repeat, unless repeat is disabled
+ */
+static void schedule_repeat(uint16_t interval_ms)
+{
+    if (g_state.config.repeat_rate_ms == 0) {
+        ay3600_timer_wheel_cancel(&g_state.timers, TIMER_KEY);
+        return;
+    }
+    ay3600_timer_wheel_schedule(&g_state.timers, TIMER_KEY, g_state.now + interval_ms);
+}
+
+/**
+ * @brief Key timer expiry: advance the debounce / repeat state machine
+ */
+static void key_timer_expired(uint8_t id, void *arg)
+{
+    (void)id;
+    (void)arg;
+
+    if (g_state.resume_pending) {
+        // Nobody confirmed the key held across the reset; it is gone
+        LOG_INFO("Resumed key 0x%02X not confirmed, releasing", g_state.current_key);
+        ay3600_release_key();
+        return;
+    }
+
+    switch (g_state.state) {
+        case STATE_DEBOUNCE:
+            // Debounce complete, move to pressed state
+            g_state.state = STATE_PRESSED;
+            schedule_repeat(g_state.config.repeat_delay_ms);
+
+            // Output the key
+            set_key_output(g_state.current_key,
+                         g_state.current_control,
+                         g_state.current_shift);
+
+            g_state.stats.total_keypresses++;
+            break;
+
+        case STATE_PRESSED:
+            // Initial repeat delay elapsed, start repeating
+            g_state.state = STATE_REPEATING;
+            /* fall through */
+
+        case STATE_REPEATING:
+            // Repeat interval elapsed, output key again
+            schedule_repeat(g_state.config.repeat_rate_ms);
+
+            set_key_output(g_state.current_key,
+                         g_state.current_control,
+                         g_state.current_shift);
+
+            g_state.stats.total_repeats++;
+            break;
+
+        default:
+            break;
+    }
+}
+
 int ay3600_init(const ay3600_config_t *config)
 {
     if (!config) {
@@ -112,6 +251,9 @@ int ay3600_init(const ay3600_config_t *config)
     memset(&g_state, 0, sizeof(g_state));
     g_state.config = *config;
     g_state.state = STATE_IDLE;
+    g_state.now = now_ms();
+    ay3600_timer_wheel_init(&g_state.timers, g_state.now, key_timer_expired, NULL);
+    ay3600_loop_monitor_init(&g_state.loop, config->overrun_threshold_us);
 
     LOG_INFO("AY3600 emulator initialized (debounce=%dms, repeat_delay=%dms, repeat_rate=%dms)",
              config->debounce_ms, config->repeat_delay_ms, config->repeat_rate_ms);
@@ -121,61 +263,17 @@ int ay3600_init(const ay3600_config_t *config)
 
 void ay3600_process(void)
 {
-    uint32_t now = GET_TIME_MS();
-    uint32_t elapsed;
-
-    switch (g_state.state) {
-        case STATE_IDLE:
-            // Nothing to do
-            break;
-
-        case STATE_DEBOUNCE:
-            elapsed = now - g_state.last_change_time;
-            if (elapsed >= g_state.config.debounce_ms) {
-                // Debounce complete, move to pressed state
-                g_state.state = STATE_PRESSED;
-                g_state.last_change_time = now;
-                g_state.last_repeat_time = now;
-
-                // Output the key
-                set_key_output(g_state.current_key,
-                             g_state.current_control,
-                             g_state.current_shift);
-
-                g_state.stats.total_keypresses++;
-            }
-            break;
+    ay3600_loop_monitor_begin(&g_state.loop, now_us());
 
-        case STATE_PRESSED:
-            elapsed = now - g_state.last_change_time;
-            if (elapsed >= g_state.config.repeat_delay_ms) {
-                // Initial repeat delay elapsed, start repeating
-                g_state.state = STATE_REPEATING;
-                g_state.last_repeat_time = now;
-
-                // Output repeat
-                set_key_output(g_state.current_key,
-                             g_state.current_control,
-                             g_state.current_shift);
-
-                g_state.stats.total_repeats++;
-            }
-            break;
+    g_state.now = now_ms();
+    ay3600_timer_wheel_advance(&g_state.timers, g_state.now);
 
-        case STATE_REPEATING:
-            elapsed = now - g_state.last_repeat_time;
-            if (elapsed >= g_state.config.repeat_rate_ms) {
-                // Repeat rate interval elapsed, output key again
-                g_state.last_repeat_time = now;
-
-                set_key_output(g_state.current_key,
-                             g_state.current_control,
-                             g_state.current_shift);
+    ay3600_loop_monitor_end(&g_state.loop, now_us());
+}
 
-                g_state.stats.total_repeats++;
-            }
-            break;
-    }
+int ay3600_next_deadline(uint32_t *deadline_ms)
+{
+    return ay3600_timer_wheel_next_deadline(&g_state.timers, deadline_ms) ? 0 : -1;
 }
 
 int ay3600_press_key(uint8_t key_code, bool control, bool shift)
@@ -186,6 +284,21 @@ int ay3600_press_key(uint8_t key_code, bool control, bool shift)
 
     LOG_DEBUG("Key pressed: code=0x%02X, ctrl=%d, shift=%d", key_code, control, shift);
 
+    g_state.now = now_ms();
+    if (g_state.resume_pending) {
+        g_state.resume_pending = false;
+        if (key_code == g_state.current_key && control == g_state.current_control &&
+            shift == g_state.current_shift) {
+            // The source still holds the resumed key: carry on where it left off
+            if (g_state.resume_has_deadline) {
+                ay3600_timer_wheel_schedule(&g_state.timers, TIMER_KEY, g_state.resume_deadline);
+            } else {
+                ay3600_timer_wheel_cancel(&g_state.timers, TIMER_KEY);
+            }
+            return 0;
+        }
+    }
+
     g_state.current_key = key_code;
     g_state.current_control = control;
     g_state.current_shift = shift;
@@ -193,13 +306,13 @@ int ay3600_press_key(uint8_t key_code, bool control, bool shift)
     if (g_state.config.debounce_ms > 0) {
         // Start debounce timer
         g_state.state = STATE_DEBOUNCE;
-        g_state.last_change_time = GET_TIME_MS();
+        ay3600_timer_wheel_schedule(&g_state.timers, TIMER_KEY,
+                                    g_state.now + g_state.config.debounce_ms);
         g_state.stats.debounce_events++;
     } else {
         // No debounce, go directly to pressed
         g_state.state = STATE_PRESSED;
-        g_state.last_change_time = GET_TIME_MS();
-        g_state.last_repeat_time = GET_TIME_MS();
+        schedule_repeat(g_state.config.repeat_delay_ms);
 
         set_key_output(key_code, control, shift);
         g_state.stats.total_keypresses++;
@@ -213,6 +326,8 @@ int ay3600_release_key(void)
     LOG_DEBUG("Key released");
 
     g_state.state = STATE_IDLE;
+    g_state.resume_pending = false;
+    ay3600_timer_wheel_cancel(&g_state.timers, TIMER_KEY);
     g_state.current_key = 0;
     g_state.current_control = false;
     g_state.current_shift = false;
@@ -230,9 +345,14 @@ int ay3600_handle_event(const ay3600_key_event_t *event)
 
     if (event->pressed) {
         return ay3600_press_key(event->key_code, event->control, event->shift);
-    } else {
-        return ay3600_release_key();
     }
+
+    // Releasing a key that a newer press already replaced must not end the new one
+    if (g_state.state != STATE_IDLE && event->key_code != g_state.current_key) {
+        LOG_DEBUG("Ignoring release of rolled-over key 0x%02X", event->key_code);
+        return 0;
+    }
+    return ay3600_release_key();
 }
 
 int ay3600_get_output(ay3600_output_t *output)
@@ -250,15 +370,270 @@ void ay3600_reset(void)
     LOG_INFO("Resetting emulator");
 
     g_state.state = STATE_IDLE;
+    g_state.resume_pending = false;
+    ay3600_timer_wheel_cancel(&g_state.timers, TIMER_KEY);
     g_state.current_key = 0;
     g_state.current_control = false;
     g_state.current_shift = false;
     clear_output();
 }
 
+int ay3600_add_sink(ay3600_sink_fn_t fn, uint16_t pin_mask, void *ctx)
+{
+    if (!fn || g_state.sink_count >= AY3600_MAX_SINKS) {
+        return -1;
+    }
+
+    g_state.sinks[g_state.sink_count].fn = fn;
+    g_state.sinks[g_state.sink_count].pin_mask = pin_mask;
+    g_state.sinks[g_state.sink_count].ctx = ctx;
+    g_state.sink_count++;
+    return 0;
+}
+
+int ay3600_remove_sink(ay3600_sink_fn_t fn, void *ctx)
+{
+    for (uint8_t i = 0; i < g_state.sink_count; i++) {
+        if (g_state.sinks[i].fn == fn && g_state.sinks[i].ctx == ctx) {
+            // Keep registration order for the remaining sinks
+            memmove(&g_state.sinks[i], &g_state.sinks[i + 1],
+                    (g_state.sink_count - i - 1) * sizeof(g_state.sinks[0]));
+            g_state.sink_count--;
+            return 0;
+        }
+    }
+    return -1;
+}
+
 void ay3600_get_stats(ay3600_stats_t *stats)
 {
     if (stats) {
         *stats = g_state.stats;
+        stats->process_overruns = g_state.loop.overruns;
+        stats->max_process_interval_us = g_state.loop.worst_interval_us;
+        stats->max_process_duration_us = g_state.loop.worst_duration_us;
+    }
+}
+
+void ay3600_get_config(ay3600_config_t *config)
+{
+    if (config) {
+        *config = g_state.config;
+    }
+}
+
+void ay3600_reset_stats(void)
+{
+    memset(&g_state.stats, 0, sizeof(g_state.stats));
+    ay3600_loop_monitor_reset(&g_state.loop);
+}
+
+void ay3600_set_timing(uint16_t debounce_ms, uint16_t repeat_delay_ms,
+                       uint16_t repeat_rate_ms)
+{
+    g_state.config.debounce_ms = debounce_ms;
+    g_state.config.repeat_delay_ms = repeat_delay_ms;
+    g_state.config.repeat_rate_ms = repeat_rate_ms;
+
+    LOG_INFO("Timing changed (debounce=%dms, repeat_delay=%dms, repeat_rate=%dms)",
+             debounce_ms, repeat_delay_ms, repeat_rate_ms);
+}
+
+_Static_assert(sizeof(ay3600_snapshot_t) == 40, "ay3600_snapshot_t must not contain padding");
+
+static void snapshot_fill(ay3600_snapshot_t *snapshot, uint16_t sequence)
+{
+    uint32_t deadline;
+    bool has_deadline;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->magic = AY3600_SNAPSHOT_MAGIC;
+    snapshot->version = AY3600_SNAPSHOT_VERSION;
+    snapshot->size = sizeof(*snapshot);
+    snapshot->state = (uint8_t)g_state.state;
+    snapshot->key_code = g_state.current_key;
+    snapshot->output_code = g_state.output.key_code;
+    snapshot->flags = (g_state.current_control ? AY3600_SNAPSHOT_CONTROL : 0) |
+                      (g_state.current_shift ? AY3600_SNAPSHOT_SHIFT : 0) |
+                      (g_state.output.control ? AY3600_SNAPSHOT_OUT_CONTROL : 0) |
+                      (g_state.output.shift ? AY3600_SNAPSHOT_OUT_SHIFT : 0) |
+                      (g_state.output.any_key ? AY3600_SNAPSHOT_OUT_ANY_KEY : 0);
+    snapshot->debounce_ms = g_state.config.debounce_ms;
+    snapshot->repeat_delay_ms = g_state.config.repeat_delay_ms;
+    snapshot->repeat_rate_ms = g_state.config.repeat_rate_ms;
+
+    snapshot->sequence = sequence;
+
+    // An unconfirmed resumed key keeps its original deadline, not the wait
+    if (g_state.resume_pending) {
+        has_deadline = g_state.resume_has_deadline;
+        deadline = g_state.resume_deadline;
+    } else {
+        has_deadline = ay3600_timer_wheel_next_deadline(&g_state.timers, &deadline);
+    }
+    if (has_deadline) {
+        int32_t remaining = (int32_t)(deadline - now_ms());
+        snapshot->flags |= AY3600_SNAPSHOT_DEADLINE;
+        snapshot->deadline_in_ms = remaining > 0 ? (uint32_t)remaining : 0;
+    }
+
+    snapshot->total_keypresses = g_state.stats.total_keypresses;
+    snapshot->total_repeats = g_state.stats.total_repeats;
+    snapshot->debounce_events = g_state.stats.debounce_events;
+    snapshot->crc = crc32_compute(snapshot, offsetof(ay3600_snapshot_t, crc));
+}
+
+static bool snapshot_valid(const ay3600_snapshot_t *snapshot)
+{
+    return snapshot && snapshot->magic == AY3600_SNAPSHOT_MAGIC &&
+           snapshot->version == AY3600_SNAPSHOT_VERSION &&
+           snapshot->size == sizeof(*snapshot) &&
+           snapshot->state <= STATE_REPEATING &&
+           snapshot->key_code <= AY3600_MAX_KEY_CODE &&
+           snapshot->output_code <= AY3600_MAX_KEY_CODE &&
+           snapshot->crc == crc32_compute(snapshot, offsetof(ay3600_snapshot_t, crc));
+}
+
+/**
+ * @brief Newest valid slot of a store, or NULL if neither is valid
+ */
+static const ay3600_snapshot_t *store_newest(const ay3600_snapshot_store_t *store)
+{
+    const ay3600_snapshot_t *a = &store->slots[0];
+    const ay3600_snapshot_t *b = &store->slots[1];
+    bool a_valid = snapshot_valid(a);
+    bool b_valid = snapshot_valid(b);
+
+    if (a_valid && b_valid) {
+        // Wrap-safe sequence comparison
+        return (int16_t)(b->sequence - a->sequence) > 0 ? b : a;
+    }
+    return a_valid ? a : (b_valid ? b : NULL);
+}
+
+int ay3600_snapshot_save(ay3600_snapshot_t *snapshot)
+{
+    if (!snapshot) {
+        return -1;
+    }
+
+    snapshot_fill(snapshot, 0);
+    return 0;
+}
+
+int ay3600_snapshot_store_save(ay3600_snapshot_store_t *store)
+{
+    const ay3600_snapshot_t *newest;
+
+    if (!store) {
+        return -1;
+    }
+
+    // Only ever write the older slot, so the newest survives a torn save
+    newest = store_newest(store);
+    if (!newest) {
+        snapshot_fill(&store->slots[0], 0);
+    } else {
+        ay3600_snapshot_t *target = newest == &store->slots[0] ? &store->slots[1] : &store->slots[0];
+        snapshot_fill(target, (uint16_t)(newest->sequence + 1));
+    }
+    return 0;
+}
+
+int ay3600_snapshot_store_restore(const ay3600_snapshot_store_t *store)
+{
+    return store ? ay3600_snapshot_restore(store_newest(store)) : -1;
+}
+
+int ay3600_snapshot_restore(const ay3600_snapshot_t *snapshot)
+{
+    if (!snapshot_valid(snapshot)) {
+        return -1;
+    }
+
+    g_state.state = (ay3600_state_t)snapshot->state;
+    g_state.current_key = snapshot->key_code;
+    g_state.current_control = (snapshot->flags & AY3600_SNAPSHOT_CONTROL) != 0;
+    g_state.current_shift = (snapshot->flags & AY3600_SNAPSHOT_SHIFT) != 0;
+    g_state.config.debounce_ms = snapshot->debounce_ms;
+    g_state.config.repeat_delay_ms = snapshot->repeat_delay_ms;
+    g_state.config.repeat_rate_ms = snapshot->repeat_rate_ms;
+    g_state.stats.total_keypresses = snapshot->total_keypresses;
+    g_state.stats.total_repeats = snapshot->total_repeats;
+    g_state.stats.debounce_events = snapshot->debounce_events;
+
+    // Rebase the pending deadline onto the current clock
+    g_state.now = now_ms();
+    ay3600_timer_wheel_init(&g_state.timers, g_state.now, key_timer_expired, NULL);
+    g_state.resume_has_deadline = (snapshot->flags & AY3600_SNAPSHOT_DEADLINE) != 0;
+    g_state.resume_deadline = g_state.now + snapshot->deadline_in_ms;
+    g_state.resume_pending = g_state.state != STATE_IDLE;
+    if (g_state.resume_pending) {
+        // Hold the key, without debounce or repeat, until the source confirms it
+        ay3600_timer_wheel_schedule(&g_state.timers, TIMER_KEY,
+                                    g_state.now + AY3600_RESUME_CONFIRM_MS);
+    } else if (g_state.resume_has_deadline) {
+        ay3600_timer_wheel_schedule(&g_state.timers, TIMER_KEY, g_state.resume_deadline);
+    }
+
+    // The gap since the snapshot is not a main loop overrun
+    ay3600_loop_monitor_resync(&g_state.loop);
+
+    // Re-drive the saved levels; no strobe, the key was already typed
+    g_state.output.key_code = snapshot->output_code;
+    g_state.output.control = (snapshot->flags & AY3600_SNAPSHOT_OUT_CONTROL) != 0;
+    g_state.output.shift = (snapshot->flags & AY3600_SNAPSHOT_OUT_SHIFT) != 0;
+    g_state.output.any_key = (snapshot->flags & AY3600_SNAPSHOT_OUT_ANY_KEY) != 0;
+    g_state.output.strobe = false;
+    update_output();
+
+    LOG_INFO("Restored snapshot (state=%d, key=0x%02X, deadline in %lums)",
+             snapshot->state, snapshot->key_code, (unsigned long)snapshot->deadline_in_ms);
+    return 0;
+}
+
+int ay3600_snapshot_save_file(const char *path)
+{
+    ay3600_snapshot_t snapshot;
+    FILE *file;
+    int result = 0;
+
+    ay3600_snapshot_save(&snapshot);
+
+    file = fopen(path, "wb");
+    if (!file) {
+        return -1;
+    }
+    if (fwrite(&snapshot, sizeof(snapshot), 1, file) != 1) {
+        result = -1;
+    }
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+int ay3600_snapshot_restore_file(const char *path)
+{
+    ay3600_snapshot_t snapshot;
+    FILE *file = fopen(path, "rb");
+    size_t count;
+
+    if (!file) {
+        return -1;
+    }
+    count = fread(&snapshot, sizeof(snapshot), 1, file);
+    fclose(file);
+
+    if (count != 1) {
+        return -1;
+    }
+    return ay3600_snapshot_restore(&snapshot);
+}
+
+void ay3600_get_loop_monitor(ay3600_loop_monitor_t *monitor)
+{
+    if (monitor) {
+        *monitor = g_state.loop;
     }
 }
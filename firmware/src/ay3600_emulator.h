@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "ay3600_loop_monitor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,6 +33,20 @@ extern "C" {
  */
 #define AY3600_MAX_KEY_CODE 31
 
+/**
+ * @brief Key code assignments shared by the input translators
+ *
+ * Letters occupy 0x00-0x19 ('A' = 0x00). CONTROL and SHIFT are separate
+ * signals, so control characters and capitals reuse the letter codes.
+ */
+#define AY3600_KEY_A        0x00  /**< 'A' (letters follow in order) */
+#define AY3600_KEY_Z        0x19  /**< 'Z' */
+#define AY3600_KEY_RETURN   0x1A  /**< RETURN */
+#define AY3600_KEY_SPACE    0x1B  /**< Space bar */
+#define AY3600_KEY_ESC      0x1C  /**< ESC */
+#define AY3600_KEY_TAB      0x1D  /**< TAB */
+#define AY3600_KEY_DELETE   0x1E  /**< DELETE */
+
 /**
  * @brief AY-3600 output signal structure
  *
@@ -54,6 +69,26 @@ typedef struct {
  */
 typedef void (*ay3600_output_callback_t)(const ay3600_output_t *output);
 
+/**
+ * @brief Maximum number of registered output sinks
+ */
+#define AY3600_MAX_SINKS 4
+
+/**
+ * @brief Output sink function type
+ *
+ * Sinks receive the emulator's output state by reference; it is only
+ * valid for the duration of the call. Sinks run on the emulator task and
+ * must return quickly.
+ *
+ * @param output Pointer to current output state
+ * @param changed Pins that changed in this update (AY3600_PIN_BIT() masks
+ *                from ay3600_output.h; KSTRB is set when the strobe pulses)
+ * @param ctx Context pointer given at registration
+ */
+typedef void (*ay3600_sink_fn_t)(const ay3600_output_t *output,
+                                 uint16_t changed, void *ctx);
+
 /**
  * @brief AY-3600 emulator configuration
  */
@@ -61,13 +96,20 @@ typedef struct {
     ay3600_output_callback_t output_callback;  /**< Callback for output changes */
     uint16_t debounce_ms;                      /**< Debounce time in milliseconds */
     uint16_t repeat_delay_ms;                  /**< Initial repeat delay (default 500ms) */
-    uint16_t repeat_rate_ms;                   /**< Repeat rate (default 50ms = 20 Hz) */
+    uint16_t repeat_rate_ms;                   /**< Repeat rate (default 50ms = 20 Hz, 0 = no repeat) */
+    uint32_t overrun_threshold_us;             /**< Late ay3600_process() threshold (0 = 2ms) */
+    uint32_t (*clock_ms)(void);                /**< Time source (NULL = system tick) */
 } ay3600_config_t;
 
 /**
  * @brief Key event structure
  *
  * Represents a single key event from input source (USB/BT/matrix).
+ *
+ * A release must carry the same key_code as the press it ends. Input
+ * translators must therefore remember the code they sent for each press
+ * and not re-translate releases through state that may have changed
+ * (keyboard_layout_translate() does this per HID usage).
  */
 typedef struct {
     uint8_t key_code;    /**< Apple IIc key code (0-31) */
@@ -94,6 +136,17 @@ int ay3600_init(const ay3600_config_t *config);
  */
 void ay3600_process(void);
 
+/**
+ * @brief Get the earliest pending debounce or repeat deadline
+ *
+ * Lets the main loop sleep until the next time ay3600_process() has work
+ * to do. Deadlines have 1 ms resolution.
+ *
+ * @param deadline_ms Filled with the deadline (same clock as the emulator)
+ * @return 0 if a deadline is pending, -1 if the emulator is idle
+ */
+int ay3600_next_deadline(uint32_t *deadline_ms);
+
 /**
  * @brief Press a key
  *
@@ -116,7 +169,14 @@ int ay3600_release_key(void);
 /**
  * @brief Handle a key event
  *
- * Processes a complete key event (press or release).
+ * Processes a complete key event (press or release). A release only
+ * takes effect for the key currently held, so releasing a key that has
+ * already been rolled over by a newer press is ignored.
+ *
+ * A release is matched on key_code alone. One whose code differs from the
+ * code of its press is dropped, and the held key keeps repeating. Every
+ * input source must send the press code on release (see
+ * ay3600_key_event_t).
  *
  * @param event Key event structure
  * @return 0 on success, negative error code on failure
@@ -138,6 +198,29 @@ int ay3600_get_output(ay3600_output_t *output);
  */
 void ay3600_reset(void);
 
+/**
+ * @brief Register an output sink
+ *
+ * The sink is called after the configured output_callback for every update
+ * that changes at least one pin in pin_mask. Registrations are cleared by
+ * ay3600_init().
+ *
+ * @param fn Sink function
+ * @param pin_mask Pins of interest (AY3600_PINS_ALL for every update)
+ * @param ctx Context pointer passed to the sink
+ * @return 0 on success, -1 if the registry is full or fn is NULL
+ */
+int ay3600_add_sink(ay3600_sink_fn_t fn, uint16_t pin_mask, void *ctx);
+
+/**
+ * @brief Unregister an output sink
+ *
+ * @param fn Sink function
+ * @param ctx Context pointer given at registration
+ * @return 0 on success, -1 if no such sink is registered
+ */
+int ay3600_remove_sink(ay3600_sink_fn_t fn, void *ctx);
+
 /**
  * @brief Get emulator statistics
  *
@@ -147,6 +230,9 @@ typedef struct {
     uint32_t total_keypresses;    /**< Total number of key presses */
     uint32_t total_repeats;       /**< Total number of repeated keys */
     uint32_t debounce_events;     /**< Number of debounced events */
+    uint32_t process_overruns;    /**< ay3600_process() calls later than the overrun threshold */
+    uint32_t max_process_interval_us; /**< Longest gap between ay3600_process() calls */
+    uint32_t max_process_duration_us; /**< Longest single ay3600_process() call */
 } ay3600_stats_t;
 
 /**
@@ -156,6 +242,167 @@ typedef struct {
  */
 void ay3600_get_stats(ay3600_stats_t *stats);
 
+/**
+ * @brief Get the active configuration
+ *
+ * @param config Pointer to structure to fill with the configuration
+ */
+void ay3600_get_config(ay3600_config_t *config);
+
+/**
+ * @brief Reset statistics and loop timing measurements
+ */
+void ay3600_reset_stats(void);
+
+/**
+ * @brief Change debounce and repeat timing
+ *
+ * Takes effect for the next debounce or repeat deadline; a deadline that is
+ * already pending keeps its original time. Like the rest of the API this
+ * must be called from the task that runs ay3600_process().
+ *
+ * @param debounce_ms Debounce time in milliseconds
+ * @param repeat_delay_ms Initial repeat delay in milliseconds
+ * @param repeat_rate_ms Repeat period in milliseconds
+ */
+void ay3600_set_timing(uint16_t debounce_ms, uint16_t repeat_delay_ms,
+                       uint16_t repeat_rate_ms);
+
+/**
+ * @brief Snapshot format identification
+ */
+#define AY3600_SNAPSHOT_MAGIC   0x36335941UL  /**< "AY36" little-endian */
+#define AY3600_SNAPSHOT_VERSION 1
+
+/**
+ * @brief Snapshot flag bits
+ */
+#define AY3600_SNAPSHOT_CONTROL     0x01  /**< Held key has CONTROL */
+#define AY3600_SNAPSHOT_SHIFT       0x02  /**< Held key has SHIFT */
+#define AY3600_SNAPSHOT_OUT_CONTROL 0x04  /**< CONTROL output high */
+#define AY3600_SNAPSHOT_OUT_SHIFT   0x08  /**< SHIFT output high */
+#define AY3600_SNAPSHOT_OUT_ANY_KEY 0x10  /**< ANY-KEY output high */
+#define AY3600_SNAPSHOT_DEADLINE    0x20  /**< A debounce/repeat deadline is pending */
+
+/**
+ * @brief Time a resumed held key waits for its input source to confirm it
+ */
+#ifndef AY3600_RESUME_CONFIRM_MS
+#define AY3600_RESUME_CONFIRM_MS 500
+#endif
+
+/**
+ * @brief Compact emulator state snapshot
+ *
+ * Holds everything needed to resume typing after a light-sleep wake or a
+ * watchdog reset: the held key, the output lines, timing settings, counters,
+ * and the time left until the pending deadline. The deadline is stored
+ * relative to the moment of the snapshot, so it can be rebased onto a clock
+ * that restarted. Fixed layout with no padding; the CRC-32 covers every
+ * preceding byte.
+ */
+typedef struct {
+    uint32_t magic;               /**< AY3600_SNAPSHOT_MAGIC */
+    uint16_t version;             /**< AY3600_SNAPSHOT_VERSION */
+    uint16_t size;                /**< sizeof(ay3600_snapshot_t) */
+    uint8_t state;                /**< State machine state */
+    uint8_t key_code;             /**< Held key code */
+    uint8_t output_code;          /**< Key code on D0-D4 */
+    uint8_t flags;                /**< AY3600_SNAPSHOT_* flags */
+    uint16_t debounce_ms;         /**< Debounce setting */
+    uint16_t repeat_delay_ms;     /**< Repeat delay setting */
+    uint16_t repeat_rate_ms;      /**< Repeat rate setting */
+    uint16_t sequence;            /**< Save order in an ay3600_snapshot_store_t */
+    uint32_t deadline_in_ms;      /**< Time left until the pending deadline */
+    uint32_t total_keypresses;    /**< Statistics */
+    uint32_t total_repeats;       /**< Statistics */
+    uint32_t debounce_events;     /**< Statistics */
+    uint32_t crc;                 /**< CRC-32 of all preceding fields */
+} ay3600_snapshot_t;
+
+/**
+ * @brief Capture the emulator state
+ *
+ * Cheap enough (a few microseconds) to call on every main loop iteration,
+ * e.g. into RTC memory that survives a reset.
+ *
+ * @param snapshot Filled with the current state
+ * @return 0 on success, -1 if snapshot is NULL
+ */
+int ay3600_snapshot_save(ay3600_snapshot_t *snapshot);
+
+/**
+ * @brief Resume from a snapshot
+ *
+ * Call after ay3600_init(); the output callback and sinks are kept, the
+ * timing settings come from the snapshot. The pending deadline is rebased
+ * onto the current time and the outputs are driven to the saved levels
+ * without a strobe, so a held key is neither lost nor typed twice.
+ *
+ * A held key may have come up while the firmware was down, and no release
+ * for it will ever arrive. It therefore stays on the outputs without
+ * debounce or repeat until its input source confirms it by pressing the
+ * same key again (which does not strobe). Any other event ends the wait
+ * normally; if nothing arrives within AY3600_RESUME_CONFIRM_MS the key is
+ * released.
+ *
+ * @param snapshot Snapshot to restore
+ * @return 0 on success, -1 if the snapshot is missing, corrupt or from
+ *         another version (the emulator state is unchanged)
+ */
+int ay3600_snapshot_restore(const ay3600_snapshot_t *snapshot);
+
+/**
+ * @brief Double-buffered snapshot storage
+ *
+ * Each save overwrites the older slot, so a reset in the middle of a save
+ * leaves the previous snapshot intact.
+ */
+typedef struct {
+    ay3600_snapshot_t slots[2];   /**< Snapshots, newest by sequence */
+} ay3600_snapshot_store_t;
+
+/**
+ * @brief Capture the emulator state into the older slot of a store
+ *
+ * @param store Snapshot store (e.g. in RTC memory)
+ * @return 0 on success, -1 if store is NULL
+ */
+int ay3600_snapshot_store_save(ay3600_snapshot_store_t *store);
+
+/**
+ * @brief Resume from the newest valid snapshot in a store
+ *
+ * @param store Snapshot store
+ * @return 0 on success, -1 if neither slot holds a valid snapshot
+ */
+int ay3600_snapshot_store_restore(const ay3600_snapshot_store_t *store);
+
+/**
+ * @brief Write the current state to a snapshot file
+ *
+ * @param path File path
+ * @return 0 on success, -1 on I/O error
+ */
+int ay3600_snapshot_save_file(const char *path);
+
+/**
+ * @brief Restore the state from a snapshot file
+ *
+ * @param path File path
+ * @return 0 on success, -1 on I/O error or invalid snapshot
+ */
+int ay3600_snapshot_restore_file(const char *path);
+
+/**
+ * @brief Get main loop timing measurements
+ *
+ * Copies the interval and duration histograms for ay3600_process().
+ *
+ * @param monitor Pointer to structure to fill with loop timing data
+ */
+void ay3600_get_loop_monitor(ay3600_loop_monitor_t *monitor);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,62 @@
+/**
+ * @file ay3600_loop_monitor.c
+ * @brief Main loop jitter and overrun monitor implementation
+ */
+
+#include "ay3600_loop_monitor.h"
+#include <string.h>
+
+static uint32_t clamp_us(uint64_t us)
+{
+    return us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+
+void ay3600_loop_monitor_init(ay3600_loop_monitor_t *monitor,
+                              uint32_t overrun_threshold_us)
+{
+    memset(monitor, 0, sizeof(*monitor));
+    monitor->overrun_threshold_us = overrun_threshold_us ?
+                                    overrun_threshold_us : AY3600_OVERRUN_THRESHOLD_US;
+}
+
+void ay3600_loop_monitor_begin(ay3600_loop_monitor_t *monitor, uint64_t now_us)
+{
+    if (monitor->have_last) {
+        uint32_t interval = clamp_us(now_us - monitor->last_start_us);
+
+        histogram_record(&monitor->interval_us, interval);
+        if (interval > monitor->worst_interval_us) {
+            monitor->worst_interval_us = interval;
+        }
+        if (interval > monitor->overrun_threshold_us) {
+            monitor->overruns++;
+        }
+    }
+
+    monitor->last_start_us = now_us;
+    monitor->current_start_us = now_us;
+    monitor->have_last = true;
+}
+
+void ay3600_loop_monitor_end(ay3600_loop_monitor_t *monitor, uint64_t now_us)
+{
+    uint32_t duration = clamp_us(now_us - monitor->current_start_us);
+
+    histogram_record(&monitor->duration_us, duration);
+    if (duration > monitor->worst_duration_us) {
+        monitor->worst_duration_us = duration;
+    }
+    if (duration > monitor->overrun_threshold_us) {
+        monitor->slow_calls++;
+    }
+}
+
+void ay3600_loop_monitor_resync(ay3600_loop_monitor_t *monitor)
+{
+    monitor->have_last = false;
+}
+
+void ay3600_loop_monitor_reset(ay3600_loop_monitor_t *monitor)
+{
+    ay3600_loop_monitor_init(monitor, monitor->overrun_threshold_us);
+}
@@ -0,0 +1,89 @@
+/**
+ * @file ay3600_loop_monitor.h
+ * @brief Main loop jitter and overrun monitor
+ *
+ * Records the interval between successive ay3600_process() calls and the
+ * time each call takes, in log2 histograms of microseconds. Intervals that
+ * exceed a threshold are counted as overruns: they stretch debounce and
+ * repeat timing when other tasks (USB host, BLE) hold the CPU.
+ */
+
+#ifndef AY3600_LOOP_MONITOR_H
+#define AY3600_LOOP_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "histogram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default overrun threshold (twice the 1 ms loop period)
+ */
+#define AY3600_OVERRUN_THRESHOLD_US 2000
+
+/**
+ * @brief Loop monitor state and results
+ */
+typedef struct {
+    uint32_t overrun_threshold_us;  /**< Interval counted as an overrun */
+    uint32_t overruns;              /**< Intervals above the threshold */
+    uint32_t slow_calls;            /**< Calls that took longer than the threshold */
+    uint32_t worst_interval_us;     /**< Longest interval between calls */
+    uint32_t worst_duration_us;     /**< Longest single call */
+    histogram_t interval_us;        /**< Interval between call starts */
+    histogram_t duration_us;        /**< Time spent in each call */
+    uint64_t last_start_us;         /**< Start of the previous call */
+    uint64_t current_start_us;      /**< Start of the call in progress */
+    bool have_last;                 /**< last_start_us is valid */
+} ay3600_loop_monitor_t;
+
+/**
+ * @brief Initialize a loop monitor
+ *
+ * @param monitor Monitor to initialize
+ * @param overrun_threshold_us Overrun threshold (0 selects the default)
+ */
+void ay3600_loop_monitor_init(ay3600_loop_monitor_t *monitor,
+                              uint32_t overrun_threshold_us);
+
+/**
+ * @brief Mark the start of a monitored call
+ *
+ * @param monitor Loop monitor
+ * @param now_us Current time in microseconds
+ */
+void ay3600_loop_monitor_begin(ay3600_loop_monitor_t *monitor, uint64_t now_us);
+
+/**
+ * @brief Mark the end of a monitored call
+ *
+ * @param monitor Loop monitor
+ * @param now_us Current time in microseconds
+ */
+void ay3600_loop_monitor_end(ay3600_loop_monitor_t *monitor, uint64_t now_us);
+
+/**
+ * @brief Forget the previous call time
+ *
+ * Use after an intentional pause (sleep, state restore) so the gap is not
+ * reported as an overrun.
+ *
+ * @param monitor Loop monitor
+ */
+void ay3600_loop_monitor_resync(ay3600_loop_monitor_t *monitor);
+
+/**
+ * @brief Clear all measurements, keeping the threshold
+ *
+ * @param monitor Loop monitor
+ */
+void ay3600_loop_monitor_reset(ay3600_loop_monitor_t *monitor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AY3600_LOOP_MONITOR_H */
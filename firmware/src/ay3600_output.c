@@ -0,0 +1,82 @@
+/**
+ * @file ay3600_output.c
+ * @brief AY-3600 output pin driver implementation
+ */
+
+#include "ay3600_output.h"
+#include <string.h>
+
+/**
+ * @brief Write the pins in mask whose level differs from target
+ */
+static void write_changed(ay3600_output_driver_t *driver, uint16_t mask,
+                          uint16_t target)
+{
+    uint16_t changed = (driver->levels ^ target) & mask;
+
+    while (changed) {
+        unsigned pin = __builtin_ctz(changed);
+        changed &= changed - 1;
+        driver->hal.set_pin(driver->hal.ctx, (ay3600_pin_t)pin,
+                            (target >> pin) & 1);
+    }
+    driver->levels = (driver->levels & ~mask) | (target & mask);
+}
+
+int ay3600_output_driver_init(ay3600_output_driver_t *driver,
+                              const ay3600_output_hal_t *hal,
+                              uint16_t strobe_width_us)
+{
+    if (!driver || !hal || !hal->set_pin || !hal->delay_us) {
+        return -1;
+    }
+
+    memset(driver, 0, sizeof(*driver));
+    driver->hal = *hal;
+    driver->strobe_width_us = strobe_width_us ? strobe_width_us : AY3600_STROBE_WIDTH_US;
+
+    for (unsigned pin = 0; pin < AY3600_PIN_COUNT; pin++) {
+        driver->hal.set_pin(driver->hal.ctx, (ay3600_pin_t)pin, false);
+    }
+    return 0;
+}
+
+uint16_t ay3600_output_levels(const ay3600_output_t *output)
+{
+    uint16_t levels = output->key_code & AY3600_PINS_KEY_CODE;
+
+    if (output->control) {
+        levels |= AY3600_PIN_BIT(AY3600_PIN_CONTROL);
+    }
+    if (output->shift) {
+        levels |= AY3600_PIN_BIT(AY3600_PIN_SHIFT);
+    }
+    if (output->any_key) {
+        levels |= AY3600_PIN_BIT(AY3600_PIN_ANY_KEY);
+    }
+    return levels;
+}
+
+void ay3600_output_drive(ay3600_output_driver_t *driver,
+                         const ay3600_output_t *output)
+{
+    uint16_t target = ay3600_output_levels(output);
+    const uint16_t any_key = AY3600_PIN_BIT(AY3600_PIN_ANY_KEY);
+    const uint16_t strobe = AY3600_PIN_BIT(AY3600_PIN_KSTRB);
+
+    if (output->any_key) {
+        // Data must be valid before ANY-KEY and the strobe
+        write_changed(driver, AY3600_PINS_DATA, target);
+        write_changed(driver, any_key, target);
+
+        if (output->strobe) {
+            write_changed(driver, strobe, strobe);
+            driver->hal.delay_us(driver->hal.ctx, driver->strobe_width_us);
+            write_changed(driver, strobe, 0);
+        }
+    } else {
+        // Drop ANY-KEY while the key code is still valid
+        write_changed(driver, strobe | any_key, 0);
+        write_changed(driver, AY3600_PINS_DATA, target);
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ * @file ay3600_output.h
+ * @brief AY-3600 output pin driver
+ *
+ * Turns emulator output updates into an ordered sequence of pin writes
+ * through a small hardware abstraction layer, so the same sequencing runs
+ * against real GPIO on the ESP32-C3 and against a recording HAL in tests.
+ *
+ * Signal ordering on a key press:
+ * 1. D0-D4, CONTROL and SHIFT settle to the new key
+ * 2. ANY-KEY rises
+ * 3. KSTRB pulses for the configured width
+ *
+ * On release ANY-KEY falls before the data lines are cleared, so the key
+ * code stays valid for as long as ANY-KEY is high. Only pins whose level
+ * changes are written.
+ */
+
+#ifndef AY3600_OUTPUT_H
+#define AY3600_OUTPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ay3600_emulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief AY-3600 output pins
+ */
+typedef enum {
+    AY3600_PIN_D0,        /**< Key code bit 0 */
+    AY3600_PIN_D1,        /**< Key code bit 1 */
+    AY3600_PIN_D2,        /**< Key code bit 2 */
+    AY3600_PIN_D3,        /**< Key code bit 3 */
+    AY3600_PIN_D4,        /**< Key code bit 4 */
+    AY3600_PIN_CONTROL,   /**< CONTROL */
+    AY3600_PIN_SHIFT,     /**< SHIFT */
+    AY3600_PIN_ANY_KEY,   /**< ANY-KEY */
+    AY3600_PIN_KSTRB,     /**< Keyboard strobe */
+    AY3600_PIN_COUNT
+} ay3600_pin_t;
+
+/**
+ * @brief Pin bit masks
+ */
+#define AY3600_PIN_BIT(pin)   (1U << (pin))
+#define AY3600_PINS_KEY_CODE  0x001FU  /**< D0-D4 */
+#define AY3600_PINS_DATA      0x007FU  /**< D0-D4, CONTROL, SHIFT */
+#define AY3600_PINS_ALL       0x01FFU  /**< Every output pin */
+
+/**
+ * @brief Default KSTRB pulse width in microseconds
+ */
+#define AY3600_STROBE_WIDTH_US 1
+
+/**
+ * @brief Output hardware abstraction layer
+ */
+typedef struct {
+    void (*set_pin)(void *ctx, ay3600_pin_t pin, bool level);  /**< Drive one pin */
+    void (*delay_us)(void *ctx, uint32_t us);                  /**< Busy-wait */
+    void *ctx;                                                 /**< Passed to both hooks */
+} ay3600_output_hal_t;
+
+/**
+ * @brief Output driver state
+ */
+typedef struct {
+    ay3600_output_hal_t hal;     /**< Hardware hooks */
+    uint16_t levels;             /**< Current level of each pin (bit per pin) */
+    uint16_t strobe_width_us;    /**< KSTRB pulse width */
+} ay3600_output_driver_t;
+
+/**
+ * @brief Initialize the driver and drive every pin low
+ *
+ * @param driver Driver to initialize
+ * @param hal Hardware hooks (copied)
+ * @param strobe_width_us KSTRB pulse width (0 selects the default)
+ * @return 0 on success, negative error code on failure
+ */
+int ay3600_output_driver_init(ay3600_output_driver_t *driver,
+                              const ay3600_output_hal_t *hal,
+                              uint16_t strobe_width_us);
+
+/**
+ * @brief Convert an output state to pin levels (KSTRB excluded)
+ *
+ * @param output Emulator output state
+ * @return Bit mask of pins that should be high
+ */
+uint16_t ay3600_output_levels(const ay3600_output_t *output);
+
+/**
+ * @brief Drive the pins to match an emulator output update
+ *
+ * Suitable for use directly from an output callback.
+ *
+ * @param driver Output driver
+ * @param output Emulator output state
+ */
+void ay3600_output_drive(ay3600_output_driver_t *driver,
+                         const ay3600_output_t *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AY3600_OUTPUT_H */
@@ -0,0 +1,232 @@
+/**
+ * @file ay3600_timer_wheel.c
+ * @brief Hierarchical timer wheel implementation
+ */
+
+#include "ay3600_timer_wheel.h"
+#include <string.h>
+
+#define NONE        0xFF
+#define SLOT_MASK   (AY3600_TIMER_WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(level) ((level) * AY3600_TIMER_WHEEL_SLOT_BITS)
+
+/**
+ * @brief Rotate a 64-bit bitmap right
+ */
+static uint64_t rotate_right(uint64_t bits, unsigned n)
+{
+    n &= 63;
+    return n ? (bits >> n) | (bits << (64 - n)) : bits;
+}
+
+/**
+ * @brief Index of the first occupied slot at or after start (wrapping)
+ *
+ * @return Distance from start in slots (bitmap must be non-zero)
+ */
+static unsigned first_occupied(uint64_t bitmap, unsigned start)
+{
+    return __builtin_ctzll(rotate_right(bitmap, start));
+}
+
+static void link_timer(ay3600_timer_wheel_t *wheel, uint8_t id)
+{
+    ay3600_timer_t *timer = &wheel->timers[id];
+    uint32_t delta = timer->deadline - wheel->now;
+    unsigned level = 0;
+
+    while (level < AY3600_TIMER_WHEEL_LEVELS - 1 &&
+           delta >= (1UL << LEVEL_SHIFT(level + 1))) {
+        level++;
+    }
+
+    unsigned index = (timer->deadline >> LEVEL_SHIFT(level)) & SLOT_MASK;
+    unsigned slot = level * AY3600_TIMER_WHEEL_SLOTS + index;
+
+    // Append so timers sharing a slot fire in insertion order
+    timer->slot = slot;
+    timer->next = NONE;
+    uint8_t head = wheel->heads[slot];
+    if (head == NONE) {
+        timer->prev = id;  // Head's prev points at the tail
+        wheel->heads[slot] = id;
+        wheel->occupied[level] |= 1ULL << index;
+    } else {
+        uint8_t tail = wheel->timers[head].prev;
+        timer->prev = tail;
+        wheel->timers[tail].next = id;
+        wheel->timers[head].prev = id;
+    }
+}
+
+static void unlink_timer(ay3600_timer_wheel_t *wheel, uint8_t id)
+{
+    ay3600_timer_t *timer = &wheel->timers[id];
+    unsigned slot = timer->slot;
+    uint8_t head = wheel->heads[slot];
+
+    if (timer->next != NONE) {
+        wheel->timers[timer->next].prev = timer->prev;
+    } else {
+        wheel->timers[head].prev = timer->prev;  // New tail
+    }
+
+    if (id == head) {
+        wheel->heads[slot] = timer->next;
+        if (timer->next == NONE) {
+            unsigned level = slot / AY3600_TIMER_WHEEL_SLOTS;
+            wheel->occupied[level] &= ~(1ULL << (slot & SLOT_MASK));
+        }
+    } else {
+        wheel->timers[timer->prev].next = timer->next;
+    }
+
+    timer->slot = NONE;
+}
+
+/**
+ * @brief Move every timer in a higher-level slot down the hierarchy
+ */
+static void cascade(ay3600_timer_wheel_t *wheel, unsigned level)
+{
+    unsigned index = (wheel->now >> LEVEL_SHIFT(level)) & SLOT_MASK;
+    unsigned slot = level * AY3600_TIMER_WHEEL_SLOTS + index;
+
+    while (wheel->heads[slot] != NONE) {
+        uint8_t id = wheel->heads[slot];
+        unlink_timer(wheel, id);
+        link_timer(wheel, id);
+    }
+}
+
+void ay3600_timer_wheel_init(ay3600_timer_wheel_t *wheel, uint32_t now,
+                             ay3600_timer_callback_t callback, void *arg)
+{
+    memset(wheel, 0, sizeof(*wheel));
+    memset(wheel->heads, NONE, sizeof(wheel->heads));
+    for (unsigned i = 0; i < AY3600_TIMER_WHEEL_CAPACITY; i++) {
+        wheel->timers[i].slot = NONE;
+    }
+    wheel->now = now;
+    wheel->callback = callback;
+    wheel->arg = arg;
+}
+
+int ay3600_timer_wheel_schedule(ay3600_timer_wheel_t *wheel, uint8_t id,
+                                uint32_t deadline)
+{
+    if (id >= AY3600_TIMER_WHEEL_CAPACITY) {
+        return -1;
+    }
+
+    if (wheel->timers[id].slot != NONE) {
+        unlink_timer(wheel, id);
+    }
+
+    // The current millisecond has already been processed
+    int32_t delta = (int32_t)(deadline - wheel->now);
+    if (delta <= 0) {
+        deadline = wheel->now + 1;
+    } else if ((uint32_t)delta > AY3600_TIMER_WHEEL_MAX_DELAY) {
+        deadline = wheel->now + AY3600_TIMER_WHEEL_MAX_DELAY;
+    }
+
+    wheel->timers[id].deadline = deadline;
+    link_timer(wheel, id);
+    return 0;
+}
+
+int ay3600_timer_wheel_cancel(ay3600_timer_wheel_t *wheel, uint8_t id)
+{
+    if (id >= AY3600_TIMER_WHEEL_CAPACITY) {
+        return -1;
+    }
+
+    if (wheel->timers[id].slot != NONE) {
+        unlink_timer(wheel, id);
+    }
+    return 0;
+}
+
+bool ay3600_timer_wheel_active(const ay3600_timer_wheel_t *wheel, uint8_t id)
+{
+    return id < AY3600_TIMER_WHEEL_CAPACITY && wheel->timers[id].slot != NONE;
+}
+
+int ay3600_timer_wheel_advance(ay3600_timer_wheel_t *wheel, uint32_t now)
+{
+    int fired = 0;
+
+    while ((int32_t)(now - wheel->now) > 0) {
+        uint32_t remaining = now - wheel->now;
+        uint32_t step = UINT32_MAX;
+
+        if (wheel->occupied[0]) {
+            step = first_occupied(wheel->occupied[0], (wheel->now + 1) & SLOT_MASK) + 1;
+        }
+        if (wheel->occupied[1] | wheel->occupied[2]) {
+            // Next level-0 wrap, where higher levels cascade
+            uint32_t wrap = AY3600_TIMER_WHEEL_SLOTS - (wheel->now & SLOT_MASK);
+            if (wrap < step) {
+                step = wrap;
+            }
+        }
+
+        if (step > remaining) {
+            wheel->now = now;
+            break;
+        }
+        wheel->now += step;
+
+        if ((wheel->now & SLOT_MASK) == 0) {
+            if (((wheel->now >> LEVEL_SHIFT(1)) & SLOT_MASK) == 0) {
+                cascade(wheel, 2);
+            }
+            cascade(wheel, 1);
+        }
+
+        unsigned slot = wheel->now & SLOT_MASK;
+        while (wheel->heads[slot] != NONE) {
+            uint8_t id = wheel->heads[slot];
+            unlink_timer(wheel, id);
+            fired++;
+            if (wheel->callback) {
+                wheel->callback(id, wheel->arg);
+            }
+        }
+    }
+
+    return fired;
+}
+
+bool ay3600_timer_wheel_next_deadline(const ay3600_timer_wheel_t *wheel,
+                                      uint32_t *deadline)
+{
+    bool found = false;
+    uint32_t best = 0;
+
+    for (unsigned level = 0; level < AY3600_TIMER_WHEEL_LEVELS; level++) {
+        uint64_t bitmap = wheel->occupied[level];
+        if (!bitmap) {
+            continue;
+        }
+
+        // Slots are visited in rotation order starting after the current one
+        unsigned start = ((wheel->now >> LEVEL_SHIFT(level)) + 1) & SLOT_MASK;
+        unsigned index = (start + first_occupied(bitmap, start)) & SLOT_MASK;
+        uint8_t id = wheel->heads[level * AY3600_TIMER_WHEEL_SLOTS + index];
+
+        for (; id != NONE; id = wheel->timers[id].next) {
+            uint32_t d = wheel->timers[id].deadline;
+            if (!found || (int32_t)(d - best) < 0) {
+                best = d;
+                found = true;
+            }
+        }
+    }
+
+    if (found && deadline) {
+        *deadline = best;
+    }
+    return found;
+}
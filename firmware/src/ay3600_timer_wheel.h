@@ -0,0 +1,148 @@
+/**
+ * @file ay3600_timer_wheel.h
+ * @brief Hierarchical timer wheel for emulator deadlines
+ *
+ * Fixed-capacity timer wheel with millisecond resolution, used by the
+ * emulator for debounce and repeat deadlines. Three levels of 64 slots
+ * cover deadlines up to ~262 seconds ahead; later deadlines are clamped.
+ *
+ * - Insert and cancel are O(1) (intrusive doubly linked slot lists)
+ * - Timers fire in deadline order; timers sharing a millisecond fire in
+ *   insertion order
+ * - Advancing skips empty slots using per-level occupancy bitmaps, so the
+ *   cost of a tick does not depend on how many timers are pending
+ * - The earliest pending deadline can be queried to size idle sleeps
+ *
+ * Timers are identified by a small integer chosen by the owner (for
+ * example one per tracked key). Deadlines are absolute times in
+ * milliseconds and wrap safely.
+ */
+
+#ifndef AY3600_TIMER_WHEEL_H
+#define AY3600_TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of timers a wheel can hold
+ */
+#define AY3600_TIMER_WHEEL_CAPACITY 16
+
+/**
+ * @brief Wheel geometry
+ */
+#define AY3600_TIMER_WHEEL_SLOT_BITS 6
+#define AY3600_TIMER_WHEEL_SLOTS     (1U << AY3600_TIMER_WHEEL_SLOT_BITS)
+#define AY3600_TIMER_WHEEL_LEVELS    3
+
+/**
+ * @brief Longest supported delay in milliseconds
+ */
+#define AY3600_TIMER_WHEEL_MAX_DELAY \
+    ((1UL << (AY3600_TIMER_WHEEL_SLOT_BITS * AY3600_TIMER_WHEEL_LEVELS)) - 1)
+
+/**
+ * @brief Timer expiry callback
+ *
+ * Called from ay3600_timer_wheel_advance(). The timer is already inactive
+ * and may be rescheduled from the callback.
+ *
+ * @param id Timer that expired
+ * @param arg Argument given to ay3600_timer_wheel_init()
+ */
+typedef void (*ay3600_timer_callback_t)(uint8_t id, void *arg);
+
+/**
+ * @brief Timer slot entry
+ */
+typedef struct {
+    uint32_t deadline;   /**< Absolute expiry time */
+    uint8_t next;        /**< Next timer in slot list */
+    uint8_t prev;        /**< Previous timer in slot list */
+    uint8_t slot;        /**< Wheel slot, or 0xFF if inactive */
+} ay3600_timer_t;
+
+/**
+ * @brief Timer wheel
+ */
+typedef struct {
+    uint32_t now;                                   /**< Last time advanced to */
+    uint64_t occupied[AY3600_TIMER_WHEEL_LEVELS];   /**< Non-empty slot bitmap per level */
+    uint8_t heads[AY3600_TIMER_WHEEL_LEVELS * AY3600_TIMER_WHEEL_SLOTS]; /**< Slot list heads */
+    ay3600_timer_t timers[AY3600_TIMER_WHEEL_CAPACITY]; /**< Timer storage */
+    ay3600_timer_callback_t callback;               /**< Expiry callback */
+    void *arg;                                      /**< Callback argument */
+} ay3600_timer_wheel_t;
+
+/**
+ * @brief Initialize a timer wheel with no pending timers
+ *
+ * @param wheel Wheel to initialize
+ * @param now Current time in milliseconds
+ * @param callback Expiry callback
+ * @param arg Callback argument
+ */
+void ay3600_timer_wheel_init(ay3600_timer_wheel_t *wheel, uint32_t now,
+                             ay3600_timer_callback_t callback, void *arg);
+
+/**
+ * @brief Schedule (or reschedule) a timer
+ *
+ * Deadlines at or before the wheel's current time fire on the next
+ * millisecond.
+ *
+ * @param wheel Timer wheel
+ * @param id Timer identifier (0 to AY3600_TIMER_WHEEL_CAPACITY - 1)
+ * @param deadline Absolute expiry time in milliseconds
+ * @return 0 on success, -1 on invalid id
+ */
+int ay3600_timer_wheel_schedule(ay3600_timer_wheel_t *wheel, uint8_t id,
+                                uint32_t deadline);
+
+/**
+ * @brief Cancel a timer
+ *
+ * @param wheel Timer wheel
+ * @param id Timer identifier
+ * @return 0 on success (including an already inactive timer), -1 on invalid id
+ */
+int ay3600_timer_wheel_cancel(ay3600_timer_wheel_t *wheel, uint8_t id);
+
+/**
+ * @brief Check whether a timer is pending
+ *
+ * @param wheel Timer wheel
+ * @param id Timer identifier
+ * @return true if the timer is scheduled
+ */
+bool ay3600_timer_wheel_active(const ay3600_timer_wheel_t *wheel, uint8_t id);
+
+/**
+ * @brief Advance time and fire every timer that has expired
+ *
+ * @param wheel Timer wheel
+ * @param now Current time in milliseconds
+ * @return Number of timers fired
+ */
+int ay3600_timer_wheel_advance(ay3600_timer_wheel_t *wheel, uint32_t now);
+
+/**
+ * @brief Get the earliest pending deadline
+ *
+ * @param wheel Timer wheel
+ * @param deadline Filled with the earliest deadline
+ * @return true if a timer is pending
+ */
+bool ay3600_timer_wheel_next_deadline(const ay3600_timer_wheel_t *wheel,
+                                      uint32_t *deadline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AY3600_TIMER_WHEEL_H */
@@ -0,0 +1,289 @@
+/**
+ * @file ay3600_timing.c
+ * @brief AY-3600 output timing recorder and conformance checker
+ */
+
+#include "ay3600_timing.h"
+#include <string.h>
+
+/*
+ * Recorder
+ */
+
+static uint64_t trace_now(const ay3600_trace_t *trace)
+{
+    return trace->clock_ns ? trace->clock_ns() : trace->now_ns;
+}
+
+static void trace_set_pin(void *ctx, ay3600_pin_t pin, bool level)
+{
+    ay3600_trace_t *trace = ctx;
+    uint16_t bit = AY3600_PIN_BIT(pin);
+    bool current = (trace->levels & bit) != 0;
+
+    if (current != level) {
+        if (trace->count < trace->capacity) {
+            ay3600_transition_t *t = &trace->buffer[trace->count++];
+            t->time_ns = trace_now(trace);
+            t->pin = pin;
+            t->level = level;
+        } else {
+            trace->dropped++;
+        }
+        trace->levels ^= bit;
+    }
+    trace->now_ns += trace->write_cost_ns;
+}
+
+static void trace_delay_us(void *ctx, uint32_t us)
+{
+    ay3600_trace_t *trace = ctx;
+
+    if (trace->clock_ns) {
+        uint64_t end = trace->clock_ns() + (uint64_t)us * 1000;
+        while (trace->clock_ns() < end) {
+            // Busy-wait like esp_rom_delay_us()
+        }
+    }
+    trace->now_ns += (uint64_t)us * 1000;
+}
+
+void ay3600_trace_init(ay3600_trace_t *trace, ay3600_transition_t *buffer,
+                       uint32_t capacity, uint32_t write_cost_ns)
+{
+    memset(trace, 0, sizeof(*trace));
+    trace->buffer = buffer;
+    trace->capacity = capacity;
+    trace->write_cost_ns = write_cost_ns;
+}
+
+void ay3600_trace_hal(ay3600_trace_t *trace, ay3600_output_hal_t *hal)
+{
+    hal->set_pin = trace_set_pin;
+    hal->delay_us = trace_delay_us;
+    hal->ctx = trace;
+}
+
+void ay3600_trace_advance(ay3600_trace_t *trace, uint64_t ns)
+{
+    trace->now_ns += ns;
+}
+
+/*
+ * Checker
+ */
+
+/**
+ * @brief Waveform replay state
+ */
+typedef struct {
+    const ay3600_timing_limits_t *limits;
+    ay3600_timing_report_t *report;
+
+    uint16_t levels;              /**< Current pin levels */
+    uint64_t last_data_change;    /**< Time data lines last changed */
+    uint64_t strobe_rise;         /**< Time KSTRB last rose */
+    uint64_t strobe_fall;         /**< Time KSTRB last fell */
+    uint64_t any_key_rise;        /**< Time ANY-KEY last rose */
+
+    bool hold_pending;            /**< Waiting for the first change after a strobe */
+    bool changed_in_strobe;       /**< Data changed while KSTRB was high */
+    uint32_t changed_in_strobe_index;
+    uint64_t changed_in_strobe_time;
+
+    bool latched;                 /**< A strobe announced the current data */
+    bool changed_since_latch;     /**< Data changed after the strobe, AKD still high */
+    uint32_t changed_since_latch_index;
+    uint64_t changed_since_latch_time;
+
+    bool strobe_without_any_key;  /**< KSTRB rose while ANY-KEY was low */
+    uint32_t strobe_without_any_key_index;
+} checker_t;
+
+static void record_margin(checker_t *c, ay3600_timing_check_t check,
+                          uint32_t index, uint64_t time_ns, int64_t margin_ns)
+{
+    ay3600_timing_report_t *report = c->report;
+
+    if (!report->checked[check] || margin_ns < report->worst_margin_ns[check]) {
+        report->worst_margin_ns[check] = margin_ns;
+    }
+    report->checked[check] = true;
+
+    if (margin_ns < 0) {
+        if (report->violation_count < AY3600_TIMING_MAX_VIOLATIONS) {
+            ay3600_timing_violation_t *v = &report->violations[report->violation_count];
+            v->check = check;
+            v->transition = index;
+            v->time_ns = time_ns;
+            v->margin_ns = margin_ns;
+        }
+        report->violation_count++;
+    }
+}
+
+static void on_data_change(checker_t *c, uint32_t index, uint64_t t)
+{
+    if (c->levels & AY3600_PIN_BIT(AY3600_PIN_KSTRB)) {
+        if (!c->changed_in_strobe) {
+            c->changed_in_strobe = true;
+            c->changed_in_strobe_index = index;
+            c->changed_in_strobe_time = t;
+        }
+    } else if (c->hold_pending) {
+        c->hold_pending = false;
+        record_margin(c, AY3600_CHECK_DATA_HOLD, index, t,
+                      (int64_t)(t - c->strobe_fall) - c->limits->data_hold_min_ns);
+    }
+
+    if (c->latched && !c->changed_since_latch &&
+        (c->levels & AY3600_PIN_BIT(AY3600_PIN_ANY_KEY))) {
+        c->changed_since_latch = true;
+        c->changed_since_latch_index = index;
+        c->changed_since_latch_time = t;
+    }
+
+    c->last_data_change = t;
+}
+
+static void on_strobe_rise(checker_t *c, uint32_t index, uint64_t t)
+{
+    c->report->strobes++;
+    c->strobe_rise = t;
+
+    record_margin(c, AY3600_CHECK_DATA_SETUP, index, t,
+                  (int64_t)(t - c->last_data_change) - c->limits->data_setup_min_ns);
+
+    if (c->levels & AY3600_PIN_BIT(AY3600_PIN_ANY_KEY)) {
+        record_margin(c, AY3600_CHECK_ANY_KEY_SETUP, index, t,
+                      (int64_t)(t - c->any_key_rise) - c->limits->any_key_setup_min_ns);
+    } else {
+        // Resolved when ANY-KEY rises (or at the end of the trace)
+        c->strobe_without_any_key = true;
+        c->strobe_without_any_key_index = index;
+    }
+
+    c->latched = true;
+    c->changed_since_latch = false;
+}
+
+static void on_strobe_fall(checker_t *c, uint32_t index, uint64_t t)
+{
+    int64_t width = (int64_t)(t - c->strobe_rise);
+    int64_t low = width - c->limits->strobe_width_min_ns;
+    int64_t high = (int64_t)c->limits->strobe_width_max_ns - width;
+    record_margin(c, AY3600_CHECK_STROBE_WIDTH, index, t, low < high ? low : high);
+
+    c->strobe_fall = t;
+    if (c->changed_in_strobe) {
+        // Data changed before the strobe ended: negative hold time
+        c->changed_in_strobe = false;
+        record_margin(c, AY3600_CHECK_DATA_HOLD, c->changed_in_strobe_index,
+                      c->changed_in_strobe_time,
+                      -(int64_t)(t - c->changed_in_strobe_time) - c->limits->data_hold_min_ns);
+    } else {
+        c->hold_pending = true;
+    }
+}
+
+static void on_any_key_rise(checker_t *c, uint32_t index, uint64_t t)
+{
+    (void)index;
+    c->any_key_rise = t;
+
+    if (c->strobe_without_any_key) {
+        // ANY-KEY arrived after the strobe: negative setup time
+        c->strobe_without_any_key = false;
+        record_margin(c, AY3600_CHECK_ANY_KEY_SETUP, c->strobe_without_any_key_index,
+                      c->strobe_rise,
+                      -(int64_t)(t - c->strobe_rise) - c->limits->any_key_setup_min_ns);
+    }
+}
+
+static void on_any_key_fall(checker_t *c, uint32_t index, uint64_t t)
+{
+    (void)index;
+
+    if (c->changed_since_latch) {
+        // Key code changed under ANY-KEY without a strobe announcing it
+        record_margin(c, AY3600_CHECK_ANY_KEY_ORDER, c->changed_since_latch_index,
+                      c->changed_since_latch_time,
+                      (int64_t)c->changed_since_latch_time - (int64_t)t);
+    } else if (c->latched) {
+        record_margin(c, AY3600_CHECK_ANY_KEY_ORDER, index, t, 0);
+    }
+
+    c->latched = false;
+    c->changed_since_latch = false;
+}
+
+int ay3600_timing_check(const ay3600_transition_t *transitions, uint32_t count,
+                        const ay3600_timing_limits_t *limits,
+                        ay3600_timing_report_t *report)
+{
+    static const ay3600_timing_limits_t default_limits = AY3600_TIMING_LIMITS_DEFAULT;
+    checker_t c;
+
+    if ((!transitions && count) || !report) {
+        return -1;
+    }
+
+    memset(report, 0, sizeof(*report));
+    memset(&c, 0, sizeof(c));
+    c.limits = limits ? limits : &default_limits;
+    c.report = report;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const ay3600_transition_t *tr = &transitions[i];
+        uint16_t bit;
+
+        if (tr->pin >= AY3600_PIN_COUNT) {
+            continue;  // Not one of our pins
+        }
+        bit = AY3600_PIN_BIT(tr->pin);
+        if (((c.levels & bit) != 0) == (tr->level != 0)) {
+            continue;  // Not a transition
+        }
+
+        if (bit & AY3600_PINS_DATA) {
+            on_data_change(&c, i, tr->time_ns);
+        }
+
+        c.levels ^= bit;
+
+        if (tr->pin == AY3600_PIN_KSTRB) {
+            if (tr->level) {
+                on_strobe_rise(&c, i, tr->time_ns);
+            } else {
+                on_strobe_fall(&c, i, tr->time_ns);
+            }
+        } else if (tr->pin == AY3600_PIN_ANY_KEY) {
+            if (tr->level) {
+                on_any_key_rise(&c, i, tr->time_ns);
+            } else {
+                on_any_key_fall(&c, i, tr->time_ns);
+            }
+        }
+    }
+
+    if (c.strobe_without_any_key && count) {
+        uint64_t end = transitions[count - 1].time_ns;
+        record_margin(&c, AY3600_CHECK_ANY_KEY_SETUP, c.strobe_without_any_key_index,
+                      c.strobe_rise,
+                      -(int64_t)(end - c.strobe_rise) - 1 - c.limits->any_key_setup_min_ns);
+    }
+
+    return (int)report->violation_count;
+}
+
+const char *ay3600_timing_check_name(ay3600_timing_check_t check)
+{
+    switch (check) {
+        case AY3600_CHECK_STROBE_WIDTH:  return "strobe-width";
+        case AY3600_CHECK_DATA_SETUP:    return "data-setup";
+        case AY3600_CHECK_DATA_HOLD:     return "data-hold";
+        case AY3600_CHECK_ANY_KEY_SETUP: return "any-key-setup";
+        case AY3600_CHECK_ANY_KEY_ORDER: return "any-key-order";
+        default:                         return "unknown";
+    }
+}
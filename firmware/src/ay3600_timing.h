@@ -0,0 +1,181 @@
+/**
+ * @file ay3600_timing.h
+ * @brief AY-3600 output timing recorder and conformance checker
+ *
+ * The recorder is an output HAL that logs every pin transition with a
+ * nanosecond timestamp instead of driving hardware. The checker replays a
+ * recorded waveform and validates it against the signal relationships in
+ * the Apple IIc Technical Reference Manual, Section 11.7 (Figure 11-17):
+ *
+ * - KSTRB is a short pulse (~1 µs) issued on each key press
+ * - The key code, CONTROL and SHIFT are valid before KSTRB rises and stay
+ *   valid after it falls
+ * - ANY-KEY is high before the strobe and stays high while the key is down;
+ *   the key code must not change while ANY-KEY is high unless a new strobe
+ *   announces the new key
+ *
+ * Each check reports its margin (measured value minus the limit). Negative
+ * margins are violations; the worst margin per check is kept even when the
+ * waveform passes, so the output path can be tuned against the headroom.
+ */
+
+#ifndef AY3600_TIMING_H
+#define AY3600_TIMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ay3600_output.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of violations kept in a report
+ */
+#define AY3600_TIMING_MAX_VIOLATIONS 16
+
+/**
+ * @brief Recorded pin transition
+ */
+typedef struct {
+    uint64_t time_ns;    /**< Timestamp of the transition */
+    uint8_t pin;         /**< Pin (ay3600_pin_t) */
+    uint8_t level;       /**< New level */
+} ay3600_transition_t;
+
+/**
+ * @brief Transition recorder
+ *
+ * Timestamps come from clock_ns when set, otherwise from a virtual clock
+ * that advances by write_cost_ns per pin write and by the requested time
+ * per delay. Writes that do not change a pin's level are not recorded.
+ */
+typedef struct {
+    ay3600_transition_t *buffer;   /**< Caller-provided transition buffer */
+    uint32_t capacity;             /**< Buffer length in transitions */
+    uint32_t count;                /**< Transitions recorded */
+    uint32_t dropped;              /**< Transitions lost to a full buffer */
+    uint16_t levels;               /**< Current level of each pin */
+    uint64_t now_ns;               /**< Virtual clock */
+    uint32_t write_cost_ns;        /**< Virtual time per pin write */
+    uint64_t (*clock_ns)(void);    /**< Optional real clock */
+} ay3600_trace_t;
+
+/**
+ * @brief Timing limits
+ */
+typedef struct {
+    uint32_t strobe_width_min_ns;   /**< Shortest allowed KSTRB pulse */
+    uint32_t strobe_width_max_ns;   /**< Longest allowed KSTRB pulse */
+    uint32_t data_setup_min_ns;     /**< Data stable before KSTRB rises */
+    uint32_t data_hold_min_ns;      /**< Data stable after KSTRB falls */
+    uint32_t any_key_setup_min_ns;  /**< ANY-KEY high before KSTRB rises */
+} ay3600_timing_limits_t;
+
+/**
+ * @brief Default limits
+ *
+ * The ~1 µs strobe width is the figure used in docs/DESIGN.md. The 10 µs
+ * upper bound and the zero setup/hold minimums are project choices, not
+ * values from the hardware reference. With a zero minimum the data-setup
+ * and data-hold checks only confirm the ordering of the edges and cannot
+ * fail on their own. Set real minimums (e.g. for level shifter skew) to
+ * check margins.
+ */
+#define AY3600_TIMING_LIMITS_DEFAULT { \
+    .strobe_width_min_ns = 1000,       \
+    .strobe_width_max_ns = 10000,      \
+    .data_setup_min_ns = 0,            \
+    .data_hold_min_ns = 0,             \
+    .any_key_setup_min_ns = 0,         \
+}
+
+/**
+ * @brief Timing checks
+ */
+typedef enum {
+    AY3600_CHECK_STROBE_WIDTH,   /**< KSTRB pulse width within limits */
+    AY3600_CHECK_DATA_SETUP,     /**< Data settled before KSTRB rises */
+    AY3600_CHECK_DATA_HOLD,      /**< Data held after KSTRB falls */
+    AY3600_CHECK_ANY_KEY_SETUP,  /**< ANY-KEY high before KSTRB rises */
+    AY3600_CHECK_ANY_KEY_ORDER,  /**< Data unchanged while ANY-KEY is high */
+    AY3600_CHECK_COUNT
+} ay3600_timing_check_t;
+
+/**
+ * @brief A single timing violation
+ */
+typedef struct {
+    ay3600_timing_check_t check;   /**< Check that failed */
+    uint32_t transition;           /**< Index of the offending transition */
+    uint64_t time_ns;              /**< Time of the offending transition */
+    int64_t margin_ns;             /**< Measured minus limit (negative) */
+} ay3600_timing_violation_t;
+
+/**
+ * @brief Conformance report
+ */
+typedef struct {
+    uint32_t strobes;                                            /**< Strobe pulses seen */
+    uint32_t violation_count;                                    /**< Total violations */
+    ay3600_timing_violation_t violations[AY3600_TIMING_MAX_VIOLATIONS]; /**< First violations */
+    int64_t worst_margin_ns[AY3600_CHECK_COUNT];                 /**< Smallest margin per check */
+    bool checked[AY3600_CHECK_COUNT];                            /**< Check was evaluated */
+} ay3600_timing_report_t;
+
+/**
+ * @brief Initialize a recorder
+ *
+ * @param trace Recorder to initialize
+ * @param buffer Transition buffer
+ * @param capacity Buffer length in transitions
+ * @param write_cost_ns Virtual time per pin write
+ */
+void ay3600_trace_init(ay3600_trace_t *trace, ay3600_transition_t *buffer,
+                       uint32_t capacity, uint32_t write_cost_ns);
+
+/**
+ * @brief Get an output HAL that records into a trace
+ *
+ * @param trace Recorder
+ * @param hal HAL to fill in
+ */
+void ay3600_trace_hal(ay3600_trace_t *trace, ay3600_output_hal_t *hal);
+
+/**
+ * @brief Advance the virtual clock (e.g. between emulator updates)
+ *
+ * @param trace Recorder
+ * @param ns Time to advance
+ */
+void ay3600_trace_advance(ay3600_trace_t *trace, uint64_t ns);
+
+/**
+ * @brief Check a recorded waveform against timing limits
+ *
+ * All pins are assumed low before the first transition.
+ *
+ * @param transitions Recorded transitions in time order
+ * @param count Number of transitions
+ * @param limits Timing limits (NULL selects the defaults)
+ * @param report Report to fill in
+ * @return Number of violations, or negative error code on failure
+ */
+int ay3600_timing_check(const ay3600_transition_t *transitions, uint32_t count,
+                        const ay3600_timing_limits_t *limits,
+                        ay3600_timing_report_t *report);
+
+/**
+ * @brief Get a short name for a check
+ *
+ * @param check Check identifier
+ * @return Static string
+ */
+const char *ay3600_timing_check_name(ay3600_timing_check_t check);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AY3600_TIMING_H */
@@ -0,0 +1,32 @@
+/**
+ * @file crc32.h
+ * @brief CRC-32 (IEEE 802.3) for persisted state
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compute the CRC-32 of a buffer
+ *
+ * Same polynomial and conventions as zlib's crc32() (check value
+ * 0xCBF43926 for "123456789").
+ *
+ * @param data Data to checksum
+ * @param len Number of bytes
+ * @return CRC-32 value
+ */
+uint32_t crc32_compute(const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRC32_H */
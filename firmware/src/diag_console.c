@@ -0,0 +1,397 @@
+/**
+ * @file diag_console.c
+ * @brief Interactive diagnostics console implementation
+ */
+
+#include "diag_console.h"
+#include "ay3600_emulator.h"
+#include "key_injector.h"
+#include "keyboard_layout.h"
+#include "histogram.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ARGS        4
+#define PRINT_MAX       160
+#define HIST_BAR_WIDTH  32
+
+/**
+ * @brief Layout of the pending-change word
+ *
+ * Timing values are packed into one 64-bit word so the console task can
+ * hand a complete setting to the emulator task with a single atomic store.
+ */
+#define PENDING_DEBOUNCE_SHIFT  0
+#define PENDING_DELAY_SHIFT     16
+#define PENDING_RATE_SHIFT      32
+#define PENDING_TIMING          (1ULL << 48)
+#define PENDING_RESET           (1ULL << 49)
+
+typedef int (*command_fn_t)(diag_console_t *console, int argc, char **argv);
+
+/**
+ * @brief Console command table entry
+ */
+typedef struct {
+    const char *name;         /**< Command name */
+    const char *usage;        /**< Argument summary */
+    const char *help;         /**< One-line description */
+    command_fn_t fn;          /**< Handler */
+} command_t;
+
+static void print(diag_console_t *console, const char *fmt, ...)
+{
+    char text[PRINT_MAX];
+    va_list args;
+
+    va_start(args, fmt);
+    int len = vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    if (len > 0) {
+        size_t n = (size_t)len < sizeof(text) ? (size_t)len : sizeof(text) - 1;
+        console->config.write(console->config.write_ctx, text, n);
+    }
+}
+
+static void print_histogram(diag_console_t *console, const char *name,
+                            const char *unit, const histogram_t *hist)
+{
+    uint32_t peak = 0;
+
+    print(console, "%s (%s): n=%lu min=%lu p50=%lu p99=%lu max=%lu\n", name, unit,
+          (unsigned long)hist->count, (unsigned long)hist->min,
+          (unsigned long)histogram_percentile(hist, 50),
+          (unsigned long)histogram_percentile(hist, 99),
+          (unsigned long)hist->max);
+
+    for (unsigned i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (hist->buckets[i] > peak) {
+            peak = hist->buckets[i];
+        }
+    }
+
+    for (unsigned i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        char bar[HIST_BAR_WIDTH + 1];
+        unsigned width;
+
+        if (!hist->buckets[i]) {
+            continue;
+        }
+        width = (unsigned)(((uint64_t)hist->buckets[i] * HIST_BAR_WIDTH + peak - 1) / peak);
+        memset(bar, '#', width);
+        bar[width] = '\0';
+        print(console, "  <=%10lu %8lu %s\n", (unsigned long)histogram_bucket_limit(i),
+              (unsigned long)hist->buckets[i], bar);
+    }
+}
+
+static int cmd_help(diag_console_t *console, int argc, char **argv);
+
+static int cmd_stats(diag_console_t *console, int argc, char **argv)
+{
+    ay3600_stats_t stats;
+    key_injector_stats_t injector;
+    ay3600_config_t config;
+
+    (void)argc;
+    (void)argv;
+    ay3600_get_stats(&stats);
+    key_injector_get_stats(&injector);
+    ay3600_get_config(&config);
+
+    print(console, "emulator: keypresses=%lu repeats=%lu debounce=%lu\n",
+          (unsigned long)stats.total_keypresses, (unsigned long)stats.total_repeats,
+          (unsigned long)stats.debounce_events);
+    print(console, "timing:   debounce=%ums delay=%ums rate=%ums\n",
+          config.debounce_ms, config.repeat_delay_ms, config.repeat_rate_ms);
+    print(console, "loop:     overruns=%lu worst_interval=%luus worst_call=%luus\n",
+          (unsigned long)stats.process_overruns,
+          (unsigned long)stats.max_process_interval_us,
+          (unsigned long)stats.max_process_duration_us);
+    print(console, "injector: queued=%lu applied=%lu rejected=%lu max_depth=%lu "
+          "latency p50=%lums p99=%lums\n",
+          (unsigned long)injector.events_queued, (unsigned long)injector.events_applied,
+          (unsigned long)injector.events_rejected, (unsigned long)injector.max_depth,
+          (unsigned long)histogram_percentile(&injector.latency_ms, 50),
+          (unsigned long)histogram_percentile(&injector.latency_ms, 99));
+    return 0;
+}
+
+static int cmd_loop(diag_console_t *console, int argc, char **argv)
+{
+    ay3600_loop_monitor_t loop;
+
+    (void)argc;
+    (void)argv;
+    ay3600_get_loop_monitor(&loop);
+
+    print(console, "threshold=%luus overruns=%lu slow_calls=%lu\n",
+          (unsigned long)loop.overrun_threshold_us, (unsigned long)loop.overruns,
+          (unsigned long)loop.slow_calls);
+    print(console, "interval: p50=%luus p99=%luus worst=%luus\n",
+          (unsigned long)histogram_percentile(&loop.interval_us, 50),
+          (unsigned long)histogram_percentile(&loop.interval_us, 99),
+          (unsigned long)loop.worst_interval_us);
+    print(console, "call:     p50=%luus p99=%luus worst=%luus\n",
+          (unsigned long)histogram_percentile(&loop.duration_us, 50),
+          (unsigned long)histogram_percentile(&loop.duration_us, 99),
+          (unsigned long)loop.worst_duration_us);
+    return 0;
+}
+
+static int cmd_hist(diag_console_t *console, int argc, char **argv)
+{
+    const char *which = argc > 1 ? argv[1] : NULL;
+    ay3600_loop_monitor_t loop;
+    key_injector_stats_t injector;
+    bool shown = false;
+
+    ay3600_get_loop_monitor(&loop);
+    key_injector_get_stats(&injector);
+
+    if (!which || strcmp(which, "interval") == 0) {
+        print_histogram(console, "process interval", "us", &loop.interval_us);
+        shown = true;
+    }
+    if (!which || strcmp(which, "call") == 0) {
+        print_histogram(console, "process call", "us", &loop.duration_us);
+        shown = true;
+    }
+    if (!which || strcmp(which, "inject") == 0) {
+        print_histogram(console, "injector latency", "ms", &injector.latency_ms);
+        shown = true;
+    }
+
+    if (!shown) {
+        print(console, "unknown histogram '%s'\n", which);
+        return -1;
+    }
+    return 0;
+}
+
+static int cmd_set(diag_console_t *console, int argc, char **argv)
+{
+    char *end;
+    unsigned long value;
+    unsigned shift;
+    uint64_t old, updated;
+
+    if (argc != 3) {
+        print(console, "usage: set debounce|delay|rate <ms>\n");
+        return -1;
+    }
+
+    if (strcmp(argv[1], "debounce") == 0) {
+        shift = PENDING_DEBOUNCE_SHIFT;
+    } else if (strcmp(argv[1], "delay") == 0) {
+        shift = PENDING_DELAY_SHIFT;
+    } else if (strcmp(argv[1], "rate") == 0) {
+        shift = PENDING_RATE_SHIFT;
+    } else {
+        print(console, "unknown setting '%s'\n", argv[1]);
+        return -1;
+    }
+
+    value = strtoul(argv[2], &end, 10);
+    if (*argv[2] == '\0' || *end != '\0' || value > UINT16_MAX) {
+        print(console, "invalid value '%s'\n", argv[2]);
+        return -1;
+    }
+
+    // Merge with any change the emulator task has not picked up yet
+    old = __atomic_load_n(&console->pending, __ATOMIC_ACQUIRE);
+    do {
+        uint64_t timing;
+
+        if (old & PENDING_TIMING) {
+            timing = old & (PENDING_TIMING - 1);
+        } else {
+            ay3600_config_t config;
+            ay3600_get_config(&config);
+            timing = ((uint64_t)config.debounce_ms << PENDING_DEBOUNCE_SHIFT) |
+                     ((uint64_t)config.repeat_delay_ms << PENDING_DELAY_SHIFT) |
+                     ((uint64_t)config.repeat_rate_ms << PENDING_RATE_SHIFT);
+        }
+        timing = (timing & ~(0xFFFFULL << shift)) | ((uint64_t)value << shift);
+        updated = (old & PENDING_RESET) | PENDING_TIMING | timing;
+    } while (!__atomic_compare_exchange_n(&console->pending, &old, updated, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    print(console, "queued: debounce=%ums delay=%ums rate=%ums\n",
+          (unsigned)((updated >> PENDING_DEBOUNCE_SHIFT) & 0xFFFF),
+          (unsigned)((updated >> PENDING_DELAY_SHIFT) & 0xFFFF),
+          (unsigned)((updated >> PENDING_RATE_SHIFT) & 0xFFFF));
+    return 0;
+}
+
+static int cmd_reset(diag_console_t *console, int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    __atomic_fetch_or(&console->pending, PENDING_RESET, __ATOMIC_ACQ_REL);
+    print(console, "counters will be reset\n");
+    return 0;
+}
+
+static int cmd_layout(diag_console_t *console, int argc, char **argv)
+{
+    const keyboard_layout_t *layout;
+
+    if (argc > 1) {
+        layout = keyboard_layout_find(argv[1]);
+        if (!layout) {
+            print(console, "unknown layout '%s'\n", argv[1]);
+            return -1;
+        }
+        // Layout switches are a single atomic store, safe from any task
+        keyboard_layout_set(layout);
+    }
+
+    print(console, "layout: %s (available:", keyboard_layout_get()->name);
+    for (unsigned i = 0; (layout = keyboard_layout_builtin(i)) != NULL; i++) {
+        print(console, " %s", layout->name);
+    }
+    print(console, ")\n");
+    return 0;
+}
+
+static const command_t commands[] = {
+    { "help",   "",                          "List commands",                   cmd_help   },
+    { "stats",  "",                          "Emulator and injector counters",  cmd_stats  },
+    { "loop",   "",                          "Main loop jitter summary",        cmd_loop   },
+    { "hist",   "[interval|call|inject]",    "Latency and jitter histograms",   cmd_hist   },
+    { "set",    "debounce|delay|rate <ms>",  "Change key timing",               cmd_set    },
+    { "reset",  "",                          "Reset counters and histograms",   cmd_reset  },
+    { "layout", "[name]",                    "Show or switch keyboard layout",  cmd_layout },
+};
+
+#define COMMAND_COUNT (sizeof(commands) / sizeof(commands[0]))
+
+static int cmd_help(diag_console_t *console, int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        print(console, "  %-6s %-24s %s\n", commands[i].name, commands[i].usage,
+              commands[i].help);
+    }
+    return 0;
+}
+
+static void prompt(diag_console_t *console)
+{
+    console->config.write(console->config.write_ctx, "> ", 2);
+}
+
+int diag_console_init(diag_console_t *console, const diag_console_config_t *config)
+{
+    if (!console || !config || !config->write) {
+        return -1;
+    }
+
+    memset(console, 0, sizeof(*console));
+    console->config = *config;
+    prompt(console);
+    return 0;
+}
+
+int diag_console_execute(diag_console_t *console, const char *line)
+{
+    char buffer[DIAG_CONSOLE_LINE_MAX];
+    char *argv[MAX_ARGS];
+    int argc = 0;
+    char *token;
+    char *save = NULL;
+
+    strncpy(buffer, line, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    for (token = strtok_r(buffer, " \t", &save); token && argc < MAX_ARGS;
+         token = strtok_r(NULL, " \t", &save)) {
+        argv[argc++] = token;
+    }
+    if (argc == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        if (strcmp(argv[0], commands[i].name) == 0) {
+            return commands[i].fn(console, argc, argv);
+        }
+    }
+
+    print(console, "unknown command '%s' (try 'help')\n", argv[0]);
+    return -1;
+}
+
+void diag_console_feed(diag_console_t *console, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        bool after_cr = console->last_was_cr;
+
+        console->last_was_cr = c == '\r';
+        if (c == '\r' || c == '\n') {
+            // Treat CR LF as a single line end, even when split across calls
+            if (c == '\n' && after_cr) {
+                continue;
+            }
+            if (console->config.echo) {
+                console->config.write(console->config.write_ctx, "\r\n", 2);
+            }
+            if (console->overlong) {
+                print(console, "line too long\n");
+            } else {
+                console->line[console->line_len] = '\0';
+                diag_console_execute(console, console->line);
+            }
+            console->line_len = 0;
+            console->overlong = false;
+            prompt(console);
+        } else if (c == '\b' || c == 0x7F) {
+            if (console->line_len > 0) {
+                console->line_len--;
+                if (console->config.echo) {
+                    console->config.write(console->config.write_ctx, "\b \b", 3);
+                }
+            }
+        } else if (console->line_len < DIAG_CONSOLE_LINE_MAX - 1) {
+            console->line[console->line_len++] = c;
+            if (console->config.echo) {
+                console->config.write(console->config.write_ctx, &c, 1);
+            }
+        } else {
+            console->overlong = true;
+        }
+    }
+}
+
+bool diag_console_apply(diag_console_t *console)
+{
+    uint64_t pending;
+
+    // Cheap check first: this runs every main loop iteration
+    if (!__atomic_load_n(&console->pending, __ATOMIC_RELAXED)) {
+        return false;
+    }
+
+    pending = __atomic_exchange_n(&console->pending, 0, __ATOMIC_ACQ_REL);
+    if (pending & PENDING_TIMING) {
+        uint16_t debounce_ms = (uint16_t)(pending >> PENDING_DEBOUNCE_SHIFT);
+        uint32_t hold_ms = (uint32_t)debounce_ms + KEY_INJECTOR_HOLD_MARGIN_MS;
+
+        ay3600_set_timing(debounce_ms,
+                          (uint16_t)(pending >> PENDING_DELAY_SHIFT),
+                          (uint16_t)(pending >> PENDING_RATE_SHIFT));
+        // Injected keystrokes must keep outlasting the new debounce
+        key_injector_set_hold(hold_ms > UINT16_MAX ? UINT16_MAX : (uint16_t)hold_ms);
+    }
+    if (pending & PENDING_RESET) {
+        ay3600_reset_stats();
+        key_injector_reset_stats();
+    }
+    return pending != 0;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file diag_console.h
+ * @brief Interactive diagnostics console
+ *
+ * A small line-oriented command console for inspecting the emulator at
+ * runtime: statistics, latency and loop-jitter histograms, live debounce
+ * and repeat settings, and counter resets. The console is transport
+ * agnostic; input is fed with diag_console_feed() and output goes through
+ * a write hook (the serial console on the device, stdout natively).
+ *
+ * The console is meant to run on a low-priority task. It only reads
+ * emulator state; changes are queued and applied by diag_console_apply(),
+ * which the emulator task calls next to ay3600_process().
+ */
+
+#ifndef DIAG_CONSOLE_H
+#define DIAG_CONSOLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum command line length
+ */
+#define DIAG_CONSOLE_LINE_MAX 64
+
+/**
+ * @brief Output hook
+ */
+typedef void (*diag_console_write_t)(void *ctx, const char *text, size_t len);
+
+/**
+ * @brief Console configuration
+ */
+typedef struct {
+    diag_console_write_t write;   /**< Output hook */
+    void *write_ctx;              /**< Passed to write */
+    bool echo;                    /**< Echo input characters (raw serial) */
+} diag_console_config_t;
+
+/**
+ * @brief Console state
+ */
+typedef struct {
+    diag_console_config_t config;         /**< Configuration */
+    char line[DIAG_CONSOLE_LINE_MAX];     /**< Line being typed */
+    size_t line_len;                      /**< Characters in line */
+    bool overlong;                        /**< Line exceeded the buffer */
+    bool last_was_cr;                     /**< Previous byte fed was CR */
+    uint64_t pending;                     /**< Changes queued for the emulator task */
+} diag_console_t;
+
+/**
+ * @brief Initialize a console and print the prompt
+ *
+ * @param console Console to initialize
+ * @param config Configuration (copied)
+ * @return 0 on success, -1 if config or its write hook is missing
+ */
+int diag_console_init(diag_console_t *console, const diag_console_config_t *config);
+
+/**
+ * @brief Feed input characters
+ *
+ * Commands run when a line ends (CR or LF). Backspace and DEL edit the
+ * line. Call from the console task.
+ *
+ * @param console Console state
+ * @param data Input bytes
+ * @param len Number of bytes
+ */
+void diag_console_feed(diag_console_t *console, const char *data, size_t len);
+
+/**
+ * @brief Execute one command line
+ *
+ * @param console Console state
+ * @param line Command line (without terminator)
+ * @return 0 on success, -1 on unknown command or bad arguments
+ */
+int diag_console_execute(diag_console_t *console, const char *line);
+
+/**
+ * @brief Apply queued setting changes and counter resets
+ *
+ * Call from the emulator task, e.g. right after ay3600_process().
+ *
+ * @param console Console state
+ * @return true if anything was applied
+ */
+bool diag_console_apply(diag_console_t *console);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DIAG_CONSOLE_H */
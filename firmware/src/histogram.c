@@ -0,0 +1,72 @@
+/**
+ * @file histogram.c
+ * @brief Fixed-size log2 histogram implementation
+ */
+
+#include "histogram.h"
+#include <string.h>
+
+void histogram_reset(histogram_t *hist)
+{
+    if (hist) {
+        memset(hist, 0, sizeof(*hist));
+    }
+}
+
+unsigned histogram_bucket(uint32_t value)
+{
+    if (value == 0) {
+        return 0;
+    }
+    return 32 - __builtin_clz(value);
+}
+
+uint32_t histogram_bucket_limit(unsigned bucket)
+{
+    if (bucket == 0) {
+        return 0;
+    }
+    if (bucket >= 32) {
+        return UINT32_MAX;
+    }
+    return (1UL << bucket) - 1;
+}
+
+void histogram_record(histogram_t *hist, uint32_t value)
+{
+    if (hist->count == 0 || value < hist->min) {
+        hist->min = value;
+    }
+    if (value > hist->max) {
+        hist->max = value;
+    }
+    hist->buckets[histogram_bucket(value)]++;
+    hist->count++;
+    hist->sum += value;
+}
+
+uint32_t histogram_percentile(const histogram_t *hist, unsigned percent)
+{
+    if (!hist || hist->count == 0) {
+        return 0;
+    }
+    if (percent > 100) {
+        percent = 100;
+    }
+
+    // Rank of the requested sample, rounded up
+    uint64_t rank = ((uint64_t)hist->count * percent + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint32_t limit = histogram_bucket_limit(i);
+            return limit < hist->max ? limit : hist->max;
+        }
+    }
+    return hist->max;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file histogram.h
+ * @brief Fixed-size log2 histogram for latency and timing measurements
+ *
+ * Values are sorted into power-of-two buckets: bucket 0 holds 0, bucket n
+ * holds values in [2^(n-1), 2^n). Recording is a handful of integer
+ * operations, so it is cheap enough to use on the emulator's hot path.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of histogram buckets (covers the full 32-bit range)
+ */
+#define HISTOGRAM_BUCKETS 33
+
+/**
+ * @brief Log2 histogram
+ */
+typedef struct {
+    uint32_t buckets[HISTOGRAM_BUCKETS];  /**< Sample count per bucket */
+    uint32_t count;                       /**< Total number of samples */
+    uint32_t min;                         /**< Smallest sample recorded */
+    uint32_t max;                         /**< Largest sample recorded */
+    uint64_t sum;                         /**< Sum of all samples */
+} histogram_t;
+
+/**
+ * @brief Clear all samples
+ *
+ * @param hist Histogram to reset
+ */
+void histogram_reset(histogram_t *hist);
+
+/**
+ * @brief Record a single sample
+ *
+ * @param hist Histogram to update
+ * @param value Sample value
+ */
+void histogram_record(histogram_t *hist, uint32_t value);
+
+/**
+ * @brief Get the bucket index a value falls into
+ *
+ * @param value Sample value
+ * @return Bucket index (0 to HISTOGRAM_BUCKETS - 1)
+ */
+unsigned histogram_bucket(uint32_t value);
+
+/**
+ * @brief Get the upper bound of a bucket
+ *
+ * @param bucket Bucket index
+ * @return Largest value that falls into the bucket
+ */
+uint32_t histogram_bucket_limit(unsigned bucket);
+
+/**
+ * @brief Estimate a percentile from the histogram
+ *
+ * The result is the upper bound of the bucket containing the requested
+ * percentile, clamped to the largest recorded sample.
+ *
+ * @param hist Histogram to query
+ * @param percent Percentile (0-100)
+ * @return Estimated value, or 0 if the histogram is empty
+ */
+uint32_t histogram_percentile(const histogram_t *hist, unsigned percent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTOGRAM_H */
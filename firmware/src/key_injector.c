@@ -0,0 +1,167 @@
+/**
+ * @file key_injector.c
+ * @brief Paced key event injection implementation
+ */
+
+#include "key_injector.h"
+#include <string.h>
+
+#define QUEUE_MASK (KEY_INJECTOR_QUEUE_LEN - 1)
+
+/**
+ * @brief Queued key event
+ */
+typedef struct {
+    ay3600_key_event_t event;   /**< Event to apply */
+    uint16_t delay_ms;          /**< Minimum time since the previous event */
+    uint32_t queued_at;         /**< Time the event was queued */
+} queued_event_t;
+
+/**
+ * @brief Internal injector state
+ */
+typedef struct {
+    key_injector_config_t config;                  /**< Configuration */
+    key_injector_stats_t stats;                    /**< Statistics */
+    queued_event_t queue[KEY_INJECTOR_QUEUE_LEN];  /**< Event ring buffer */
+    uint32_t head;                                 /**< Next slot to apply */
+    uint32_t tail;                                 /**< Next slot to fill */
+    uint32_t last_applied;                         /**< Time of last applied event */
+    bool applied_any;                              /**< An event has been applied */
+    uint8_t last_queued_code;                      /**< Key code of the last queued event */
+    bool last_queued_press;                        /**< Last queued event was a press */
+} key_injector_state_t;
+
+static key_injector_state_t g_injector;
+
+static size_t queue_depth(void)
+{
+    return g_injector.tail - g_injector.head;
+}
+
+static void enqueue(const ay3600_key_event_t *event, uint16_t delay_ms,
+                    uint32_t now_ms)
+{
+    queued_event_t *slot = &g_injector.queue[g_injector.tail & QUEUE_MASK];
+    slot->event = *event;
+    slot->delay_ms = delay_ms;
+    slot->queued_at = now_ms;
+    g_injector.tail++;
+    g_injector.last_queued_code = event->key_code;
+    g_injector.last_queued_press = event->pressed;
+
+    g_injector.stats.events_queued++;
+    if (queue_depth() > g_injector.stats.max_depth) {
+        g_injector.stats.max_depth = queue_depth();
+    }
+}
+
+int key_injector_init(const key_injector_config_t *config)
+{
+    if (!config) {
+        return -1;
+    }
+
+    memset(&g_injector, 0, sizeof(g_injector));
+    g_injector.config = *config;
+    return 0;
+}
+
+void key_injector_set_hold(uint16_t hold_ms)
+{
+    g_injector.config.hold_ms = hold_ms;
+}
+
+size_t key_injector_space(void)
+{
+    return KEY_INJECTOR_QUEUE_LEN - queue_depth();
+}
+
+bool key_injector_pending(void)
+{
+    return queue_depth() != 0;
+}
+
+int key_injector_push(const ay3600_key_event_t *event, uint32_t now_ms)
+{
+    uint16_t delay_ms = g_injector.config.gap_ms;
+
+    if (!event) {
+        return -1;
+    }
+    if (key_injector_space() < 1) {
+        g_injector.stats.events_rejected++;
+        return -1;
+    }
+
+    // A release right after its own press must outlast debounce
+    if (!event->pressed && g_injector.last_queued_press &&
+        g_injector.last_queued_code == event->key_code &&
+        g_injector.config.hold_ms > delay_ms) {
+        delay_ms = g_injector.config.hold_ms;
+    }
+
+    enqueue(event, delay_ms, now_ms);
+    return 0;
+}
+
+int key_injector_push_keystroke(uint8_t key_code, bool control, bool shift,
+                                uint32_t now_ms)
+{
+    if (key_code > AY3600_MAX_KEY_CODE) {
+        return -1;
+    }
+    if (key_injector_space() < 2) {
+        g_injector.stats.events_rejected += 2;
+        return -1;
+    }
+
+    ay3600_key_event_t event = {
+        .key_code = key_code,
+        .control = control,
+        .shift = shift,
+        .pressed = true,
+    };
+    enqueue(&event, g_injector.config.gap_ms, now_ms);
+
+    event.pressed = false;
+    enqueue(&event, g_injector.config.hold_ms, now_ms);
+    return 0;
+}
+
+int key_injector_process(uint32_t now_ms)
+{
+    int applied = 0;
+
+    while (queue_depth() != 0) {
+        const queued_event_t *slot = &g_injector.queue[g_injector.head & QUEUE_MASK];
+
+        if (g_injector.applied_any &&
+            (now_ms - g_injector.last_applied) < slot->delay_ms) {
+            break;
+        }
+
+        ay3600_handle_event(&slot->event);
+        histogram_record(&g_injector.stats.latency_ms, now_ms - slot->queued_at);
+
+        g_injector.head++;
+        g_injector.last_applied = now_ms;
+        g_injector.applied_any = true;
+        g_injector.stats.events_applied++;
+        applied++;
+    }
+
+    return applied;
+}
+
+void key_injector_get_stats(key_injector_stats_t *stats)
+{
+    if (stats) {
+        *stats = g_injector.stats;
+    }
+}
+
+void key_injector_reset_stats(void)
+{
+    memset(&g_injector.stats, 0, sizeof(g_injector.stats));
+}
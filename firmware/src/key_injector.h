@@ -0,0 +1,146 @@
+/**
+ * @file key_injector.h
+ * @brief Paced key event injection into the AY-3600 emulator
+ *
+ * Programmatic input sources (network, macros, scripts) can produce key
+ * events far faster than the Apple IIc can consume them. The injector
+ * queues those events and applies them to the emulator at a controlled
+ * pace: each keystroke is held long enough to pass debounce and produce a
+ * strobe, and successive events are spaced by a minimum gap.
+ *
+ * @note The injector is not thread-safe. Push and process from the same
+ *       task that calls ay3600_process().
+ */
+
+#ifndef KEY_INJECTOR_H
+#define KEY_INJECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "ay3600_emulator.h"
+#include "histogram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Injection queue capacity in events (must be a power of two)
+ */
+#define KEY_INJECTOR_QUEUE_LEN 64
+
+/**
+ * @brief Hold time beyond the emulator's debounce_ms for injected keystrokes
+ */
+#define KEY_INJECTOR_HOLD_MARGIN_MS 20
+
+/**
+ * @brief Key injector configuration
+ */
+typedef struct {
+    uint16_t hold_ms;   /**< Time a keystroke is held (must exceed debounce_ms) */
+    uint16_t gap_ms;    /**< Minimum time between successive applied events */
+} key_injector_config_t;
+
+/**
+ * @brief Key injector statistics
+ */
+typedef struct {
+    uint32_t events_queued;    /**< Events accepted into the queue */
+    uint32_t events_applied;   /**< Events handed to the emulator */
+    uint32_t events_rejected;  /**< Events refused because the queue was full */
+    uint32_t max_depth;        /**< Deepest queue occupancy seen */
+    histogram_t latency_ms;    /**< Queue-to-emulator latency in milliseconds */
+} key_injector_stats_t;
+
+/**
+ * @brief Initialize the key injector
+ *
+ * Clears the queue and statistics.
+ *
+ * @param config Configuration structure
+ * @return 0 on success, negative error code on failure
+ */
+int key_injector_init(const key_injector_config_t *config);
+
+/**
+ * @brief Queue a single key event
+ *
+ * The event is applied no sooner than gap_ms after the previous one. A
+ * release that directly follows a press of the same key is held until
+ * hold_ms after that press, so split press/release pairs still strobe.
+ *
+ * @param event Key event to queue
+ * @param now_ms Current time in milliseconds
+ * @return 0 on success, -1 if event is NULL or the queue is full
+ */
+int key_injector_push(const ay3600_key_event_t *event, uint32_t now_ms);
+
+/**
+ * @brief Queue a complete keystroke (press followed by release)
+ *
+ * The release is applied hold_ms after the press. Either both events are
+ * queued or neither is.
+ *
+ * @param key_code Apple IIc key code (0-31)
+ * @param control Control modifier state
+ * @param shift Shift modifier state
+ * @param now_ms Current time in milliseconds
+ * @return 0 on success, -1 on invalid key code or insufficient queue space
+ */
+int key_injector_push_keystroke(uint8_t key_code, bool control, bool shift,
+                                uint32_t now_ms);
+
+/**
+ * @brief Change the keystroke hold time
+ *
+ * Call whenever the emulator's debounce_ms changes so injected keystrokes
+ * keep outlasting it. Applies to events queued from now on.
+ *
+ * @param hold_ms New hold time in milliseconds
+ */
+void key_injector_set_hold(uint16_t hold_ms);
+
+/**
+ * @brief Get the number of free queue slots
+ *
+ * @return Free slots (a keystroke needs two)
+ */
+size_t key_injector_space(void);
+
+/**
+ * @brief Apply all queued events that are due
+ *
+ * Call from the main loop alongside ay3600_process(). Every event whose
+ * pacing delay has elapsed is applied in one batch.
+ *
+ * @param now_ms Current time in milliseconds
+ * @return Number of events applied
+ */
+int key_injector_process(uint32_t now_ms);
+
+/**
+ * @brief Check whether events are waiting in the queue
+ *
+ * @return true if the queue is not empty
+ */
+bool key_injector_pending(void);
+
+/**
+ * @brief Get key injector statistics
+ *
+ * @param stats Pointer to structure to fill with statistics
+ */
+void key_injector_get_stats(key_injector_stats_t *stats);
+
+/**
+ * @brief Reset key injector statistics
+ */
+void key_injector_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KEY_INJECTOR_H */
@@ -0,0 +1,194 @@
+/**
+ * @file keyboard_layout.c
+ * @brief Built-in keyboard layouts and layout switching
+ */
+
+#include "keyboard_layout.h"
+#include <string.h>
+
+/**
+ * @brief Map the key at a QWERTY letter position to a letter
+ */
+#define LETTER(position, letter) \
+    [HID_USAGE_A + ((position) - 'A')] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_A + ((letter) - 'A'))
+
+/**
+ * @brief Keys shared by every layout
+ */
+#define COMMON_KEYS \
+    [HID_USAGE_ENTER] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_RETURN),     \
+    [HID_USAGE_KP_ENTER] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_RETURN),  \
+    [HID_USAGE_ESCAPE] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_ESC),       \
+    [HID_USAGE_BACKSPACE] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_DELETE), \
+    [HID_USAGE_DELETE] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_DELETE),    \
+    [HID_USAGE_TAB] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_TAB),          \
+    [HID_USAGE_SPACE] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_SPACE)
+
+const keyboard_layout_t keyboard_layout_us = {
+    .name = "us",
+    .map = {
+        LETTER('A', 'A'), LETTER('B', 'B'), LETTER('C', 'C'), LETTER('D', 'D'),
+        LETTER('E', 'E'), LETTER('F', 'F'), LETTER('G', 'G'), LETTER('H', 'H'),
+        LETTER('I', 'I'), LETTER('J', 'J'), LETTER('K', 'K'), LETTER('L', 'L'),
+        LETTER('M', 'M'), LETTER('N', 'N'), LETTER('O', 'O'), LETTER('P', 'P'),
+        LETTER('Q', 'Q'), LETTER('R', 'R'), LETTER('S', 'S'), LETTER('T', 'T'),
+        LETTER('U', 'U'), LETTER('V', 'V'), LETTER('W', 'W'), LETTER('X', 'X'),
+        LETTER('Y', 'Y'), LETTER('Z', 'Z'),
+        COMMON_KEYS,
+    },
+};
+
+// Dvorak on a QWERTY-labelled keyboard: letters move to their Dvorak positions
+const keyboard_layout_t keyboard_layout_dvorak = {
+    .name = "dvorak",
+    .map = {
+        LETTER('R', 'P'), LETTER('T', 'Y'), LETTER('Y', 'F'), LETTER('U', 'G'),
+        LETTER('I', 'C'), LETTER('O', 'R'), LETTER('P', 'L'),
+        LETTER('A', 'A'), LETTER('S', 'O'), LETTER('D', 'E'), LETTER('F', 'U'),
+        LETTER('G', 'I'), LETTER('H', 'D'), LETTER('J', 'H'), LETTER('K', 'T'),
+        LETTER('L', 'N'),
+        [HID_USAGE_SEMICOLON] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_A + ('S' - 'A')),
+        LETTER('X', 'Q'), LETTER('C', 'J'), LETTER('V', 'K'), LETTER('B', 'X'),
+        LETTER('N', 'B'), LETTER('M', 'M'),
+        [HID_USAGE_COMMA] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_A + ('W' - 'A')),
+        [HID_USAGE_PERIOD] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_A + ('V' - 'A')),
+        [HID_USAGE_SLASH] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_A + ('Z' - 'A')),
+        COMMON_KEYS,
+    },
+};
+
+// AZERTY: A/Q and Z/W swap, M sits at the QWERTY semicolon position
+const keyboard_layout_t keyboard_layout_fr = {
+    .name = "fr",
+    .map = {
+        LETTER('A', 'Q'), LETTER('B', 'B'), LETTER('C', 'C'), LETTER('D', 'D'),
+        LETTER('E', 'E'), LETTER('F', 'F'), LETTER('G', 'G'), LETTER('H', 'H'),
+        LETTER('I', 'I'), LETTER('J', 'J'), LETTER('K', 'K'), LETTER('L', 'L'),
+        LETTER('N', 'N'), LETTER('O', 'O'), LETTER('P', 'P'),
+        LETTER('Q', 'A'), LETTER('R', 'R'), LETTER('S', 'S'), LETTER('T', 'T'),
+        LETTER('U', 'U'), LETTER('V', 'V'), LETTER('W', 'Z'), LETTER('X', 'X'),
+        LETTER('Y', 'Y'), LETTER('Z', 'W'),
+        [HID_USAGE_SEMICOLON] = KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_A + ('M' - 'A')),
+        COMMON_KEYS,
+    },
+};
+
+// QWERTZ: Y and Z swap
+const keyboard_layout_t keyboard_layout_de = {
+    .name = "de",
+    .map = {
+        LETTER('A', 'A'), LETTER('B', 'B'), LETTER('C', 'C'), LETTER('D', 'D'),
+        LETTER('E', 'E'), LETTER('F', 'F'), LETTER('G', 'G'), LETTER('H', 'H'),
+        LETTER('I', 'I'), LETTER('J', 'J'), LETTER('K', 'K'), LETTER('L', 'L'),
+        LETTER('M', 'M'), LETTER('N', 'N'), LETTER('O', 'O'), LETTER('P', 'P'),
+        LETTER('Q', 'Q'), LETTER('R', 'R'), LETTER('S', 'S'), LETTER('T', 'T'),
+        LETTER('U', 'U'), LETTER('V', 'V'), LETTER('W', 'W'), LETTER('X', 'X'),
+        LETTER('Y', 'Z'), LETTER('Z', 'Y'),
+        COMMON_KEYS,
+    },
+};
+
+static const keyboard_layout_t *const builtin_layouts[] = {
+    &keyboard_layout_us,
+    &keyboard_layout_dvorak,
+    &keyboard_layout_fr,
+    &keyboard_layout_de,
+};
+
+#define BUILTIN_LAYOUT_COUNT (sizeof(builtin_layouts) / sizeof(builtin_layouts[0]))
+
+const keyboard_layout_t *keyboard_layout_current = &keyboard_layout_us;
+
+/** Entry each held HID usage was pressed with (0 if not held) */
+static uint8_t held_entries[KEYBOARD_LAYOUT_SIZE];
+
+int keyboard_layout_set(const keyboard_layout_t *layout)
+{
+    if (!layout) {
+        return -1;
+    }
+
+    __atomic_store_n(&keyboard_layout_current, layout, __ATOMIC_RELEASE);
+    return 0;
+}
+
+const keyboard_layout_t *keyboard_layout_get(void)
+{
+    return __atomic_load_n(&keyboard_layout_current, __ATOMIC_ACQUIRE);
+}
+
+const keyboard_layout_t *keyboard_layout_find(const char *name)
+{
+    if (!name) {
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < BUILTIN_LAYOUT_COUNT; i++) {
+        if (strcmp(builtin_layouts[i]->name, name) == 0) {
+            return builtin_layouts[i];
+        }
+    }
+    return NULL;
+}
+
+const keyboard_layout_t *keyboard_layout_builtin(unsigned index)
+{
+    return index < BUILTIN_LAYOUT_COUNT ? builtin_layouts[index] : NULL;
+}
+
+int keyboard_layout_translate(uint8_t usage, bool control, bool shift,
+                              bool pressed, ay3600_key_event_t *event)
+{
+    uint8_t entry;
+
+    if (!event) {
+        return -1;
+    }
+
+    // A release must name the code its press sent, whatever the layout is now
+    if (!pressed && (held_entries[usage] & KEYBOARD_LAYOUT_VALID)) {
+        entry = held_entries[usage];
+    } else {
+        entry = keyboard_layout_lookup(usage);
+    }
+    held_entries[usage] = pressed ? entry : 0;
+
+    if (!(entry & KEYBOARD_LAYOUT_VALID)) {
+        return -1;
+    }
+
+    event->key_code = entry & KEYBOARD_LAYOUT_CODE_MASK;
+    event->control = control || (entry & KEYBOARD_LAYOUT_CONTROL);
+    event->shift = shift || (entry & KEYBOARD_LAYOUT_SHIFT);
+    event->pressed = pressed;
+    return 0;
+}
+
+void keyboard_layout_clear_held(void)
+{
+    memset(held_entries, 0, sizeof(held_entries));
+}
+
+int keyboard_layout_copy(keyboard_layout_t *dst, const keyboard_layout_t *src,
+                         const char *name)
+{
+    if (!dst || !src || dst == keyboard_layout_get()) {
+        return -1;
+    }
+
+    if (dst != src) {
+        memcpy(dst->map, src->map, sizeof(dst->map));
+    }
+    dst->name = name ? name : src->name;
+    return 0;
+}
+
+int keyboard_layout_remap(keyboard_layout_t *layout, uint8_t usage, uint8_t entry)
+{
+    if (!layout || layout == keyboard_layout_get()) {
+        return -1;
+    }
+
+    layout->map[usage] = entry;
+    return 0;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file keyboard_layout.h
+ * @brief Runtime-switchable keyboard layouts
+ *
+ * Translates USB HID keyboard usage IDs into AY-3600 key events. Each
+ * layout is a flat 256-entry table indexed directly by usage ID, so a
+ * lookup is a single load with no searching. The active layout is a single
+ * pointer that can be swapped atomically while typing continues; a lookup
+ * sees either the old table or the new one, never a mix.
+ *
+ * Table entries pack the key code and flags into one byte:
+ * - bits 0-4: Apple IIc key code
+ * - bit 5: force CONTROL
+ * - bit 6: force SHIFT
+ * - bit 7: entry is mapped
+ *
+ * User remaps are built by copying a layout into RAM, editing the copy and
+ * then activating it. Never edit the table that is currently active.
+ */
+
+#ifndef KEYBOARD_LAYOUT_H
+#define KEYBOARD_LAYOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ay3600_emulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of entries in a layout table (one per HID usage ID)
+ */
+#define KEYBOARD_LAYOUT_SIZE 256
+
+/**
+ * @brief Layout entry fields
+ */
+#define KEYBOARD_LAYOUT_CODE_MASK 0x1F  /**< Apple IIc key code */
+#define KEYBOARD_LAYOUT_CONTROL   0x20  /**< Force CONTROL */
+#define KEYBOARD_LAYOUT_SHIFT     0x40  /**< Force SHIFT */
+#define KEYBOARD_LAYOUT_VALID     0x80  /**< Entry is mapped */
+
+/**
+ * @brief Build a layout entry for a key code
+ */
+#define KEYBOARD_LAYOUT_ENTRY(code) \
+    (uint8_t)(KEYBOARD_LAYOUT_VALID | ((code) & KEYBOARD_LAYOUT_CODE_MASK))
+
+/**
+ * @brief USB HID keyboard usage IDs used by the built-in layouts
+ */
+#define HID_USAGE_A          0x04  /**< 'A' (letters follow in order) */
+#define HID_USAGE_ENTER      0x28
+#define HID_USAGE_ESCAPE     0x29
+#define HID_USAGE_BACKSPACE  0x2A
+#define HID_USAGE_TAB        0x2B
+#define HID_USAGE_SPACE      0x2C
+#define HID_USAGE_SEMICOLON  0x33
+#define HID_USAGE_COMMA      0x36
+#define HID_USAGE_PERIOD     0x37
+#define HID_USAGE_SLASH      0x38
+#define HID_USAGE_DELETE     0x4C
+#define HID_USAGE_KP_ENTER   0x58
+
+/**
+ * @brief Keyboard layout
+ */
+typedef struct {
+    const char *name;                       /**< Short layout name */
+    uint8_t map[KEYBOARD_LAYOUT_SIZE];      /**< Entry per HID usage ID */
+} keyboard_layout_t;
+
+/**
+ * @brief Built-in layouts
+ */
+extern const keyboard_layout_t keyboard_layout_us;      /**< US QWERTY */
+extern const keyboard_layout_t keyboard_layout_dvorak;  /**< US Dvorak */
+extern const keyboard_layout_t keyboard_layout_fr;      /**< French AZERTY */
+extern const keyboard_layout_t keyboard_layout_de;      /**< German QWERTZ */
+
+/**
+ * @brief Active layout (use keyboard_layout_set() to change it)
+ */
+extern const keyboard_layout_t *keyboard_layout_current;
+
+/**
+ * @brief Look up the active layout entry for a HID usage ID
+ *
+ * @param usage HID keyboard usage ID
+ * @return Layout entry (0 if unmapped)
+ */
+static inline uint8_t keyboard_layout_lookup(uint8_t usage)
+{
+    return __atomic_load_n(&keyboard_layout_current, __ATOMIC_ACQUIRE)->map[usage];
+}
+
+/**
+ * @brief Activate a layout
+ *
+ * Safe to call from any task while lookups are in progress.
+ *
+ * @param layout Layout to activate (must outlive its use)
+ * @return 0 on success, negative error code on failure
+ */
+int keyboard_layout_set(const keyboard_layout_t *layout);
+
+/**
+ * @brief Get the active layout
+ *
+ * @return Active layout
+ */
+const keyboard_layout_t *keyboard_layout_get(void);
+
+/**
+ * @brief Find a built-in layout by name
+ *
+ * @param name Layout name ("us", "dvorak", "fr", "de")
+ * @return Layout, or NULL if not found
+ */
+const keyboard_layout_t *keyboard_layout_find(const char *name);
+
+/**
+ * @brief Get a built-in layout by index
+ *
+ * @param index Layout index
+ * @return Layout, or NULL past the last built-in layout
+ */
+const keyboard_layout_t *keyboard_layout_builtin(unsigned index);
+
+/**
+ * @brief Translate a HID key into an AY-3600 key event
+ *
+ * Modifier state from the input device is combined with any modifiers the
+ * layout entry forces. The entry used for a press is remembered per usage
+ * and reused for its release, so a release sends the same key code as the
+ * press even if the layout was switched in between (ay3600_handle_event()
+ * ignores a release for any other code). Call from a single input task.
+ *
+ * @param usage HID keyboard usage ID
+ * @param control Control modifier state
+ * @param shift Shift modifier state
+ * @param pressed True if key pressed, false if released
+ * @param event Event to fill in
+ * @return 0 on success, -1 if the key is not mapped or event is NULL
+ */
+int keyboard_layout_translate(uint8_t usage, bool control, bool shift,
+                              bool pressed, ay3600_key_event_t *event);
+
+/**
+ * @brief Forget which HID usages are held
+ *
+ * Call together with ay3600_init() or ay3600_reset(), and when the input
+ * device is (re)initialized, so stale presses do not shape later releases.
+ */
+void keyboard_layout_clear_held(void);
+
+/**
+ * @brief Copy a layout into a writable table for remapping
+ *
+ * @param dst Destination table (must not be the active layout)
+ * @param src Layout to copy
+ * @param name Name for the new layout (NULL keeps the source name)
+ * @return 0 on success, negative error code on failure
+ */
+int keyboard_layout_copy(keyboard_layout_t *dst, const keyboard_layout_t *src,
+                         const char *name);
+
+/**
+ * @brief Remap a single key in a writable layout
+ *
+ * @param layout Layout to edit (must not be the active layout)
+ * @param usage HID keyboard usage ID
+ * @param entry New entry (KEYBOARD_LAYOUT_ENTRY() plus flags, or 0 to unmap)
+ * @return 0 on success, negative error code on failure
+ */
+int keyboard_layout_remap(keyboard_layout_t *layout, uint8_t usage, uint8_t entry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KEYBOARD_LAYOUT_H */
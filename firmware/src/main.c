@@ -10,11 +10,35 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_system.h"
 #include "driver/gpio.h"
 #include "ay3600_emulator.h"
+#include "ay3600_output.h"
+#include "key_injector.h"
+#include "keyboard_layout.h"
+#include "diag_console.h"
+#ifdef NET_KEYBOARD_ENABLE
+#include <netinet/in.h>
+#include "net_keyboard.h"
+#endif
+#ifdef SIGNAL_MONITOR_ENABLE
+#include "driver/uart.h"
+#include "signal_monitor.h"
+#endif
 
 static const char *TAG = "main";
 
+/**
+ * @brief Emulator snapshots kept in RTC memory across resets
+ *
+ * Refreshed every main loop iteration and restored after any reset that
+ * is not a power-on, so a key held across a watchdog reset keeps working.
+ * Double-buffered: a reset in the middle of a save leaves the previous
+ * snapshot intact.
+ */
+static RTC_NOINIT_ATTR ay3600_snapshot_store_t rtc_snapshots;
+
 // GPIO pin definitions (match your hardware)
 #define PIN_D0      GPIO_NUM_0
 #define PIN_D1      GPIO_NUM_1
@@ -55,29 +79,120 @@ static void init_gpio(void)
     gpio_set_level(PIN_KSTRB, 0);
 }
 
+/**
+ * @brief AY3600 pin to GPIO mapping
+ */
+static const gpio_num_t pin_map[AY3600_PIN_COUNT] = {
+    [AY3600_PIN_D0] = PIN_D0,
+    [AY3600_PIN_D1] = PIN_D1,
+    [AY3600_PIN_D2] = PIN_D2,
+    [AY3600_PIN_D3] = PIN_D3,
+    [AY3600_PIN_D4] = PIN_D4,
+    [AY3600_PIN_CONTROL] = PIN_CONTROL,
+    [AY3600_PIN_SHIFT] = PIN_SHIFT,
+    [AY3600_PIN_ANY_KEY] = PIN_ANY_KEY,
+    [AY3600_PIN_KSTRB] = PIN_KSTRB,
+};
+
+static ay3600_output_driver_t output_driver;
+
+static void gpio_hal_set_pin(void *ctx, ay3600_pin_t pin, bool level)
+{
+    (void)ctx;
+    gpio_set_level(pin_map[pin], level);
+}
+
+static void gpio_hal_delay_us(void *ctx, uint32_t us)
+{
+    (void)ctx;
+    esp_rom_delay_us(us);
+}
+
+#ifdef SIGNAL_MONITOR_ENABLE
+// Signal monitor stream on a dedicated UART, away from the log console.
+// GPIO 9 is a strapping pin; TX idles high, which is the normal boot level.
+#define SIGNAL_MONITOR_UART     UART_NUM_1
+#define SIGNAL_MONITOR_TX_PIN   GPIO_NUM_9
+#define SIGNAL_MONITOR_BAUD     921600
+
+static signal_monitor_t signal_monitor;
+
+/**
+ * @brief Non-blocking UART transport for the signal monitor
+ */
+static int uart_monitor_write(void *ctx, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    return uart_tx_chars(SIGNAL_MONITOR_UART, (const char *)data, len);
+}
+
+static void init_signal_monitor(void)
+{
+    uart_config_t uart_config = {
+        .baud_rate = SIGNAL_MONITOR_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+    };
+    signal_monitor_config_t monitor_config = {
+        .write = uart_monitor_write,
+    };
+
+    uart_driver_install(SIGNAL_MONITOR_UART, 256, 1024, 0, NULL, 0);
+    uart_param_config(SIGNAL_MONITOR_UART, &uart_config);
+    uart_set_pin(SIGNAL_MONITOR_UART, SIGNAL_MONITOR_TX_PIN, UART_PIN_NO_CHANGE,
+                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+
+    signal_monitor_init(&signal_monitor, &monitor_config);
+    ay3600_add_sink(signal_monitor_sink, AY3600_PINS_ALL, &signal_monitor);
+    ESP_LOGI(TAG, "Signal monitor streaming on UART%d", SIGNAL_MONITOR_UART);
+}
+#endif
+
+#if defined(CONFIG_FREERTOS_HZ) && CONFIG_FREERTOS_HZ < 1000
+#warning "Main loop runs once per tick; set CONFIG_FREERTOS_HZ=1000 (sdkconfig.defaults)"
+#endif
+
+// The emulator loop must preempt the console whenever it is runnable
+#define MAIN_TASK_PRIORITY      5
+#define CONSOLE_TASK_PRIORITY   (tskIDLE_PRIORITY + 1)
+#define CONSOLE_TASK_STACK      4096
+#define CONSOLE_POLL_MS         20
+
+static diag_console_t console;
+
+static void console_write(void *ctx, const char *text, size_t len)
+{
+    (void)ctx;
+    fwrite(text, 1, len, stdout);
+    fflush(stdout);
+}
+
+/**
+ * @brief Low-priority task that reads and runs console commands
+ */
+static void console_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        int c = getchar();
+        if (c == EOF) {
+            vTaskDelay(pdMS_TO_TICKS(CONSOLE_POLL_MS));
+            continue;
+        }
+        char ch = (char)c;
+        diag_console_feed(&console, &ch, 1);
+    }
+}
+
 /**
  * @brief GPIO output callback for AY3600 emulator
  */
 static void gpio_output_callback(const ay3600_output_t *output)
 {
-    // Set data lines (D0-D4)
-    gpio_set_level(PIN_D0, (output->key_code >> 0) & 1);
-    gpio_set_level(PIN_D1, (output->key_code >> 1) & 1);
-    gpio_set_level(PIN_D2, (output->key_code >> 2) & 1);
-    gpio_set_level(PIN_D3, (output->key_code >> 3) & 1);
-    gpio_set_level(PIN_D4, (output->key_code >> 4) & 1);
-
-    // Set modifier lines
-    gpio_set_level(PIN_CONTROL, output->control);
-    gpio_set_level(PIN_SHIFT, output->shift);
-    gpio_set_level(PIN_ANY_KEY, output->any_key);
-
-    // Pulse KSTRB if key is pressed
-    if (output->any_key) {
-        gpio_set_level(PIN_KSTRB, 1);
-        esp_rom_delay_us(1); // 1μs pulse
-        gpio_set_level(PIN_KSTRB, 0);
-    }
+    ay3600_output_drive(&output_driver, output);
 }
 
 void app_main(void)
@@ -86,6 +201,11 @@ void app_main(void)
 
     // Initialize GPIO
     init_gpio();
+    ay3600_output_hal_t gpio_hal = {
+        .set_pin = gpio_hal_set_pin,
+        .delay_us = gpio_hal_delay_us,
+    };
+    ay3600_output_driver_init(&output_driver, &gpio_hal, AY3600_STROBE_WIDTH_US);
     ESP_LOGI(TAG, "GPIO initialized");
 
     // Initialize AY3600 emulator
@@ -97,24 +217,104 @@ void app_main(void)
     };
 
     ay3600_init(&config);
+    keyboard_layout_clear_held();
     ESP_LOGI(TAG, "AY3600 emulator initialized");
 
+    // RTC memory holds garbage after power-on; the snapshot CRC rejects it anyway
+    bool resumed = esp_reset_reason() != ESP_RST_POWERON &&
+                   ay3600_snapshot_store_restore(&rtc_snapshots) == 0;
+    if (resumed) {
+        ESP_LOGI(TAG, "Resumed emulator state from RTC memory");
+        ay3600_get_config(&config);
+    }
+
+#ifdef SIGNAL_MONITOR_ENABLE
+    init_signal_monitor();
+#endif
+
+    // Paced injection for programmatic input (hold must outlast debounce)
+    key_injector_config_t injector_config = {
+        .hold_ms = config.debounce_ms + KEY_INJECTOR_HOLD_MARGIN_MS,
+        .gap_ms = 10,
+    };
+    key_injector_init(&injector_config);
+
+    // Diagnostics console on the serial console, below the main loop
+    diag_console_config_t console_config = {
+        .write = console_write,
+        .echo = true,
+    };
+    diag_console_init(&console, &console_config);
+    vTaskPrioritySet(NULL, MAIN_TASK_PRIORITY);
+    xTaskCreate(console_task, "diag_console", CONSOLE_TASK_STACK, NULL,
+                CONSOLE_TASK_PRIORITY, NULL);
+
     // TODO: Initialize USB Host
     // TODO: Initialize Bluetooth
 
-    // Test: Send a test keystroke
-    ESP_LOGI(TAG, "Sending test 'A' keystroke...");
-    ay3600_press_key(0x00, false, false); // 'A' key
-    vTaskDelay(pdMS_TO_TICKS(100));
-    ay3600_release_key();
+#ifdef NET_KEYBOARD_ENABLE
+    // No interface is brought up here; see the README's network section
+    net_keyboard_config_t net_config = {
+        .port = NET_KEYBOARD_DEFAULT_PORT,
+        .bind_addr = INADDR_ANY,
+    };
+    if (net_keyboard_start(&net_config) != 0) {
+        ESP_LOGW(TAG, "Network keyboard server failed to start");
+    }
+#endif
+
+    // Test: Send a test keystroke (not over a resumed key)
+    if (!resumed) {
+        ESP_LOGI(TAG, "Sending test 'A' keystroke...");
+        ay3600_press_key(0x00, false, false); // 'A' key
+        vTaskDelay(pdMS_TO_TICKS(100));
+        ay3600_release_key();
+    }
 
     ESP_LOGI(TAG, "Initialization complete. Entering main loop...");
 
     // Main loop
+    uint32_t last_overrun_check = 0;
+    uint32_t reported_overruns = 0;
+
     while (1) {
+        uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+#ifdef NET_KEYBOARD_ENABLE
+        net_keyboard_poll(now);
+#endif
+        key_injector_process(now);
+
         // Process keyboard events
         ay3600_process();
+        diag_console_apply(&console);
+        ay3600_snapshot_store_save(&rtc_snapshots);
+
+#ifdef SIGNAL_MONITOR_ENABLE
+        // After the GPIO work so streaming never delays the outputs
+        signal_monitor_flush(&signal_monitor);
+#endif
+
+        // Report late processing at most once per second
+        if (now - last_overrun_check >= 1000) {
+            ay3600_stats_t stats;
+            ay3600_get_stats(&stats);
+            if (stats.process_overruns < reported_overruns) {
+                // Counters were reset (console 'reset'); count from zero again
+                reported_overruns = 0;
+            }
+            if (stats.process_overruns != reported_overruns) {
+                ESP_LOGW(TAG, "Main loop overran %lu times (worst interval %lu us, worst call %lu us)",
+                         (unsigned long)(stats.process_overruns - reported_overruns),
+                         (unsigned long)stats.max_process_interval_us,
+                         (unsigned long)stats.max_process_duration_us);
+                reported_overruns = stats.process_overruns;
+            }
+            last_overrun_check = now;
+        }
 
-        vTaskDelay(pdMS_TO_TICKS(1)); // 1ms tick
+        // Block for a whole tick so the console and IDLE tasks get to run;
+        // pdMS_TO_TICKS(1) is 0 below a 1 kHz tick and would never block
+        vTaskDelay(1);
     }
 }
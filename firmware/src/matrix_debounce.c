@@ -0,0 +1,305 @@
+/**
+ * @file matrix_debounce.c
+ * @brief Adaptive per-key debounce for the keyboard matrix
+ */
+
+#include "matrix_debounce.h"
+#include "crc32.h"
+#include <string.h>
+#include <stdio.h>
+
+/** Header: magic (4), version, keys, history, reserved */
+#define BLOB_HEADER_LEN 8
+/** Per key: history length + samples */
+#define BLOB_KEY_LEN    (1 + 2 * MATRIX_DEBOUNCE_HISTORY)
+
+_Static_assert(MATRIX_DEBOUNCE_KEYS <= 255, "key index must fit in uint8_t");
+_Static_assert(MATRIX_DEBOUNCE_HISTORY <= 255, "history length must fit in uint8_t");
+
+static void put_u16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t value)
+{
+    put_u16(p, (uint16_t)value);
+    put_u16(p + 2, (uint16_t)(value >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+/**
+ * @brief Recompute a key's lockout from its bounce history
+ */
+static void update_lockout(const matrix_debounce_config_t *config, matrix_debounce_key_t *k)
+{
+    uint16_t sorted[MATRIX_DEBOUNCE_HISTORY];
+    uint32_t lockout;
+    uint8_t rank;
+
+    if (k->history_len < config->min_samples) {
+        k->lockout_us = config->max_lockout_us;
+        return;
+    }
+
+    // Insertion sort; the history is tiny
+    for (uint8_t i = 0; i < k->history_len; i++) {
+        uint16_t value = k->history[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+
+    // Nearest-rank percentile
+    rank = (uint8_t)((config->percentile * k->history_len + 99) / 100);
+    lockout = (uint32_t)sorted[rank - 1] * config->margin_percent / 100;
+
+    if (lockout < config->min_lockout_us) {
+        lockout = config->min_lockout_us;
+    } else if (lockout > config->max_lockout_us) {
+        lockout = config->max_lockout_us;
+    }
+    k->lockout_us = (uint16_t)lockout;
+}
+
+static void push_sample(matrix_debounce_key_t *k, uint32_t duration_us)
+{
+    k->history[k->history_pos] = duration_us > UINT16_MAX ? UINT16_MAX : (uint16_t)duration_us;
+    k->history_pos = (uint8_t)((k->history_pos + 1) % MATRIX_DEBOUNCE_HISTORY);
+    if (k->history_len < MATRIX_DEBOUNCE_HISTORY) {
+        k->history_len++;
+    }
+}
+
+static void pop_sample(matrix_debounce_key_t *k)
+{
+    if (k->history_len == 0) {
+        return;
+    }
+    k->history_pos = (uint8_t)((k->history_pos + MATRIX_DEBOUNCE_HISTORY - 1) % MATRIX_DEBOUNCE_HISTORY);
+    k->history_len--;
+}
+
+int matrix_debounce_init(matrix_debounce_t *debounce, const matrix_debounce_config_t *config)
+{
+    static const matrix_debounce_config_t defaults = MATRIX_DEBOUNCE_CONFIG_DEFAULT;
+
+    if (!debounce) {
+        return -1;
+    }
+    if (!config) {
+        config = &defaults;
+    }
+    if (config->min_lockout_us == 0 || config->min_lockout_us > config->max_lockout_us ||
+        config->percentile == 0 || config->percentile > 100 ||
+        config->margin_percent < 100 ||
+        config->min_samples == 0 || config->min_samples > MATRIX_DEBOUNCE_HISTORY) {
+        return -1;
+    }
+
+    memset(debounce, 0, sizeof(*debounce));
+    debounce->config = *config;
+    for (int i = 0; i < MATRIX_DEBOUNCE_KEYS; i++) {
+        debounce->keys[i].lockout_us = config->max_lockout_us;
+    }
+    return 0;
+}
+
+int matrix_debounce_update(matrix_debounce_t *debounce, uint8_t key, bool raw,
+                           uint32_t now_us, bool *pressed)
+{
+    matrix_debounce_key_t *k;
+
+    if (!debounce || key >= MATRIX_DEBOUNCE_KEYS) {
+        return -1;
+    }
+    k = &debounce->keys[key];
+
+    if (raw != k->raw) {
+        debounce->stats.edges++;
+        k->raw = raw;
+        if (!k->bursting) {
+            k->bursting = true;
+            if (k->reported && k->lockout_us < debounce->config.max_lockout_us &&
+                (uint32_t)(now_us - k->reported_us) < k->lockout_us) {
+                // The burst behind the last report outlasted a learned lockout; extend it
+                pop_sample(k);
+                k->burst_start_us = k->prev_burst_start_us;
+                k->reported = false;
+                k->chatter++;
+                debounce->stats.chatter++;
+            } else {
+                k->burst_start_us = now_us;
+            }
+        }
+        k->last_edge_us = now_us;
+        return 0;
+    }
+
+    if (!k->bursting || (uint32_t)(now_us - k->last_edge_us) < k->lockout_us) {
+        return 0;
+    }
+
+    // Quiet for a full lockout: the burst is over
+    k->bursting = false;
+    push_sample(k, k->last_edge_us - k->burst_start_us);
+    update_lockout(&debounce->config, k);
+    k->prev_burst_start_us = k->burst_start_us;
+
+    if (k->raw == k->stable) {
+        debounce->stats.glitches++;
+        return 0;
+    }
+
+    k->stable = k->raw;
+    k->reported = true;
+    k->reported_us = now_us;
+    debounce->stats.reports++;
+    if (pressed) {
+        *pressed = k->stable;
+    }
+    return 1;
+}
+
+uint32_t matrix_debounce_lockout_us(const matrix_debounce_t *debounce, uint8_t key)
+{
+    if (!debounce || key >= MATRIX_DEBOUNCE_KEYS) {
+        return 0;
+    }
+    return debounce->keys[key].lockout_us;
+}
+
+void matrix_debounce_get_stats(const matrix_debounce_t *debounce, matrix_debounce_stats_t *stats)
+{
+    if (debounce && stats) {
+        *stats = debounce->stats;
+    }
+}
+
+size_t matrix_debounce_export(const matrix_debounce_t *debounce, uint8_t *buffer, size_t size)
+{
+    uint8_t *p = buffer;
+
+    if (!debounce || !buffer || size < MATRIX_DEBOUNCE_BLOB_SIZE) {
+        return 0;
+    }
+
+    put_u32(p, MATRIX_DEBOUNCE_MAGIC);
+    p[4] = MATRIX_DEBOUNCE_VERSION;
+    p[5] = MATRIX_DEBOUNCE_KEYS;
+    p[6] = MATRIX_DEBOUNCE_HISTORY;
+    p[7] = 0;
+    p += BLOB_HEADER_LEN;
+
+    for (int i = 0; i < MATRIX_DEBOUNCE_KEYS; i++) {
+        const matrix_debounce_key_t *k = &debounce->keys[i];
+        // Oldest sample first, so import can rebuild the ring
+        uint8_t start = k->history_len < MATRIX_DEBOUNCE_HISTORY ? 0 : k->history_pos;
+
+        memset(p, 0, BLOB_KEY_LEN);
+        p[0] = k->history_len;
+        for (uint8_t j = 0; j < k->history_len; j++) {
+            put_u16(p + 1 + 2 * j, k->history[(start + j) % MATRIX_DEBOUNCE_HISTORY]);
+        }
+        p += BLOB_KEY_LEN;
+    }
+
+    put_u32(p, crc32_compute(buffer, (size_t)(p - buffer)));
+    return MATRIX_DEBOUNCE_BLOB_SIZE;
+}
+
+int matrix_debounce_import(matrix_debounce_t *debounce, const uint8_t *buffer, size_t size)
+{
+    const size_t body_len = MATRIX_DEBOUNCE_BLOB_SIZE - 4;
+    const uint8_t *p;
+
+    if (!debounce || !buffer || size != MATRIX_DEBOUNCE_BLOB_SIZE) {
+        return -1;
+    }
+    if (get_u32(buffer) != MATRIX_DEBOUNCE_MAGIC ||
+        buffer[4] != MATRIX_DEBOUNCE_VERSION ||
+        buffer[5] != MATRIX_DEBOUNCE_KEYS ||
+        buffer[6] != MATRIX_DEBOUNCE_HISTORY ||
+        get_u32(buffer + body_len) != crc32_compute(buffer, body_len)) {
+        return -1;
+    }
+
+    // Validate every key before touching any state
+    p = buffer + BLOB_HEADER_LEN;
+    for (int i = 0; i < MATRIX_DEBOUNCE_KEYS; i++, p += BLOB_KEY_LEN) {
+        if (p[0] > MATRIX_DEBOUNCE_HISTORY) {
+            return -1;
+        }
+    }
+
+    p = buffer + BLOB_HEADER_LEN;
+    for (int i = 0; i < MATRIX_DEBOUNCE_KEYS; i++, p += BLOB_KEY_LEN) {
+        matrix_debounce_key_t *k = &debounce->keys[i];
+
+        memset(k->history, 0, sizeof(k->history));
+        k->history_len = p[0];
+        k->history_pos = (uint8_t)(k->history_len % MATRIX_DEBOUNCE_HISTORY);
+        for (uint8_t j = 0; j < k->history_len; j++) {
+            k->history[j] = get_u16(p + 1 + 2 * j);
+        }
+        update_lockout(&debounce->config, k);
+    }
+    return 0;
+}
+
+int matrix_debounce_save_file(const matrix_debounce_t *debounce, const char *path)
+{
+    uint8_t blob[MATRIX_DEBOUNCE_BLOB_SIZE];
+    FILE *file;
+    int result = 0;
+
+    if (matrix_debounce_export(debounce, blob, sizeof(blob)) == 0 || !path) {
+        return -1;
+    }
+
+    file = fopen(path, "wb");
+    if (!file) {
+        return -1;
+    }
+    if (fwrite(blob, sizeof(blob), 1, file) != 1) {
+        result = -1;
+    }
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+int matrix_debounce_load_file(matrix_debounce_t *debounce, const char *path)
+{
+    uint8_t blob[MATRIX_DEBOUNCE_BLOB_SIZE + 1];
+    FILE *file;
+    size_t count;
+
+    if (!debounce || !path) {
+        return -1;
+    }
+
+    file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    // Read one byte extra so oversized files are rejected
+    count = fread(blob, 1, sizeof(blob), file);
+    fclose(file);
+
+    return matrix_debounce_import(debounce, blob, count);
+}
@@ -0,0 +1,191 @@
+/**
+ * @file matrix_debounce.h
+ * @brief Adaptive per-key debounce for the keyboard matrix
+ *
+ * Debounces raw matrix samples key by key. A change is reported once the
+ * key has been quiet for its own lockout time. Each bounce burst (first
+ * edge to last edge) is recorded in a small per-key history, and the key's
+ * lockout becomes a percentile of that history times a safety margin,
+ * clamped to configured bounds. Keys start at the maximum lockout until
+ * enough bursts have been seen, so healthy switches speed up as they are
+ * learned while worn ones keep a long lockout.
+ *
+ * A new burst that starts within one lockout of a report means the previous
+ * burst was still going when the lockout expired. That burst's sample is extended to
+ * cover the new edge and counted as chatter, which raises the lockout.
+ *
+ * When the matrix path uses this module, the emulator's own debounce_ms
+ * should be 0.
+ */
+
+#ifndef MATRIX_DEBOUNCE_H
+#define MATRIX_DEBOUNCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Matrix geometry (Apple IIc keyboard, 18 x 6)
+ */
+#define MATRIX_DEBOUNCE_COLUMNS 18
+#define MATRIX_DEBOUNCE_ROWS    6
+#define MATRIX_DEBOUNCE_KEYS    (MATRIX_DEBOUNCE_COLUMNS * MATRIX_DEBOUNCE_ROWS)
+
+/**
+ * @brief Bounce samples kept per key
+ */
+#define MATRIX_DEBOUNCE_HISTORY 8
+
+/**
+ * @brief Persisted blob format
+ */
+#define MATRIX_DEBOUNCE_MAGIC   0x3142444DUL  /**< "MDB1" little-endian */
+#define MATRIX_DEBOUNCE_VERSION 1
+#define MATRIX_DEBOUNCE_BLOB_SIZE \
+    (8 + MATRIX_DEBOUNCE_KEYS * (1 + 2 * MATRIX_DEBOUNCE_HISTORY) + 4)
+
+/**
+ * @brief Debouncer configuration
+ */
+typedef struct {
+    uint16_t min_lockout_us;    /**< Shortest lockout (at least one scan period) */
+    uint16_t max_lockout_us;    /**< Longest lockout, used until a key is learned */
+    uint8_t percentile;         /**< Percentile of the bounce history (1-100) */
+    uint16_t margin_percent;    /**< Safety margin applied to the percentile */
+    uint8_t min_samples;        /**< Bursts needed before adapting */
+} matrix_debounce_config_t;
+
+/**
+ * @brief Default configuration: 1-20 ms, 1.5 x p95 after 6 bursts
+ */
+#define MATRIX_DEBOUNCE_CONFIG_DEFAULT { \
+    .min_lockout_us = 1000,              \
+    .max_lockout_us = 20000,             \
+    .percentile = 95,                    \
+    .margin_percent = 150,               \
+    .min_samples = 6,                    \
+}
+
+/**
+ * @brief Per-key debounce state
+ */
+typedef struct {
+    uint16_t history[MATRIX_DEBOUNCE_HISTORY]; /**< Bounce durations (us) */
+    uint8_t history_len;        /**< Valid samples */
+    uint8_t history_pos;        /**< Next slot to overwrite */
+    uint16_t lockout_us;        /**< Current quiet time before reporting */
+    bool raw;                   /**< Last raw sample */
+    bool stable;                /**< Reported (debounced) state */
+    bool bursting;              /**< Edges seen since the last quiet period */
+    bool reported;              /**< reported_us is valid */
+    uint32_t burst_start_us;    /**< First edge of the current burst */
+    uint32_t last_edge_us;      /**< Most recent edge */
+    uint32_t prev_burst_start_us; /**< First edge of the previous burst */
+    uint32_t reported_us;       /**< Time of the last reported change */
+    uint16_t chatter;           /**< Chatter events on this key */
+} matrix_debounce_key_t;
+
+/**
+ * @brief Debouncer statistics
+ */
+typedef struct {
+    uint32_t edges;             /**< Raw transitions seen */
+    uint32_t reports;           /**< Debounced changes reported */
+    uint32_t glitches;          /**< Bursts that settled back without a change */
+    uint32_t chatter;           /**< Bursts that outlasted the lockout */
+} matrix_debounce_stats_t;
+
+/**
+ * @brief Debouncer state for the whole matrix
+ */
+typedef struct {
+    matrix_debounce_config_t config;                   /**< Configuration */
+    matrix_debounce_key_t keys[MATRIX_DEBOUNCE_KEYS];  /**< Per-key state */
+    matrix_debounce_stats_t stats;                     /**< Statistics */
+} matrix_debounce_t;
+
+/**
+ * @brief Initialize the debouncer with all keys released and unlearned
+ *
+ * @param debounce Debouncer state
+ * @param config Configuration (NULL selects MATRIX_DEBOUNCE_CONFIG_DEFAULT)
+ * @return 0 on success, -1 on invalid configuration
+ */
+int matrix_debounce_init(matrix_debounce_t *debounce, const matrix_debounce_config_t *config);
+
+/**
+ * @brief Feed one raw sample
+ *
+ * Call for every key on every scan, changed or not, so quiet periods are
+ * noticed. Timestamps may wrap.
+ *
+ * @param debounce Debouncer state
+ * @param key Key index (row * MATRIX_DEBOUNCE_COLUMNS + column)
+ * @param raw Raw level, true when the switch is closed
+ * @param now_us Scan time in microseconds
+ * @param pressed Filled with the new state when a change is reported
+ * @return 1 if a debounced change is reported, 0 if not, -1 on bad key
+ */
+int matrix_debounce_update(matrix_debounce_t *debounce, uint8_t key, bool raw,
+                           uint32_t now_us, bool *pressed);
+
+/**
+ * @brief Current lockout of a key in microseconds (0 for a bad key)
+ */
+uint32_t matrix_debounce_lockout_us(const matrix_debounce_t *debounce, uint8_t key);
+
+/**
+ * @brief Get debouncer statistics
+ */
+void matrix_debounce_get_stats(const matrix_debounce_t *debounce, matrix_debounce_stats_t *stats);
+
+/**
+ * @brief Serialize the learned bounce histories
+ *
+ * The blob is versioned and CRC-checked, with a fixed byte order, so it can
+ * be kept in NVS or a file and loaded by later firmware.
+ *
+ * @param debounce Debouncer state
+ * @param buffer Output buffer
+ * @param size Buffer size (at least MATRIX_DEBOUNCE_BLOB_SIZE)
+ * @return Bytes written, or 0 if the buffer is too small
+ */
+size_t matrix_debounce_export(const matrix_debounce_t *debounce, uint8_t *buffer, size_t size);
+
+/**
+ * @brief Load learned bounce histories and recompute every lockout
+ *
+ * Key states are not changed. The current configuration's bounds apply.
+ *
+ * @param debounce Debouncer state
+ * @param buffer Blob from matrix_debounce_export()
+ * @param size Blob size
+ * @return 0 on success, -1 if the blob is truncated, corrupt or from another
+ *         version or geometry (the debouncer is unchanged)
+ */
+int matrix_debounce_import(matrix_debounce_t *debounce, const uint8_t *buffer, size_t size);
+
+/**
+ * @brief Write the learned histories to a file
+ *
+ * @return 0 on success, -1 on I/O error
+ */
+int matrix_debounce_save_file(const matrix_debounce_t *debounce, const char *path);
+
+/**
+ * @brief Load learned histories from a file
+ *
+ * @return 0 on success, -1 on I/O error or invalid blob
+ */
+int matrix_debounce_load_file(matrix_debounce_t *debounce, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MATRIX_DEBOUNCE_H */
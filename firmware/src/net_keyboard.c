@@ -0,0 +1,291 @@
+/**
+ * @file net_keyboard.c
+ * @brief TCP keyboard server implementation
+ */
+
+#include "net_keyboard.h"
+#include "key_injector.h"
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifndef NATIVE_TEST
+#include "esp_log.h"
+#define LOG_TAG "net_kbd"
+#define LOG_INFO(fmt, ...)  ESP_LOGI(LOG_TAG, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  ESP_LOGW(LOG_TAG, fmt, ##__VA_ARGS__)
+#else
+#include <stdio.h>
+#define LOG_INFO(fmt, ...)  printf("[INFO] " fmt "\n", ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  printf("[WARN] " fmt "\n", ##__VA_ARGS__)
+#endif
+
+/**
+ * @brief Per-connection state
+ */
+typedef struct {
+    int fd;                 /**< Socket, or -1 if the slot is free */
+    bool frame_pending;     /**< Frame marker seen, event byte outstanding */
+    bool last_was_cr;       /**< Previous text byte was CR (swallow LF) */
+} net_client_t;
+
+/**
+ * @brief Internal server state
+ */
+typedef struct {
+    int listen_fd;                                   /**< Listening socket */
+    uint16_t port;                                   /**< Bound port */
+    unsigned next_client;                            /**< Round-robin start slot */
+    net_client_t clients[NET_KEYBOARD_MAX_CLIENTS];  /**< Connection slots */
+    net_keyboard_stats_t stats;                      /**< Statistics */
+} net_keyboard_state_t;
+
+static net_keyboard_state_t g_server = { .listen_fd = -1 };
+
+static int set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) {
+        return -1;
+    }
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static void close_client(net_client_t *client)
+{
+    close(client->fd);
+    client->fd = -1;
+}
+
+/**
+ * @brief Translate one text byte into a keystroke and queue it
+ *
+ * @return Number of events queued (0 or 2)
+ */
+static int queue_text_byte(net_client_t *client, uint8_t c, uint32_t now_ms)
+{
+    uint8_t code;
+    bool control = false;
+    bool shift = false;
+
+    if (c == '\n' && client->last_was_cr) {
+        client->last_was_cr = false;
+        return 0;
+    }
+    client->last_was_cr = (c == '\r');
+
+    if (c >= 'a' && c <= 'z') {
+        code = AY3600_KEY_A + (c - 'a');
+    } else if (c >= 'A' && c <= 'Z') {
+        code = AY3600_KEY_A + (c - 'A');
+        shift = true;
+    } else if (c == '\r' || c == '\n') {
+        code = AY3600_KEY_RETURN;
+    } else if (c == ' ') {
+        code = AY3600_KEY_SPACE;
+    } else if (c == 0x1B) {
+        code = AY3600_KEY_ESC;
+    } else if (c == '\t') {
+        code = AY3600_KEY_TAB;
+    } else if (c == 0x08 || c == 0x7F) {
+        code = AY3600_KEY_DELETE;
+    } else if (c >= 0x01 && c <= 0x1A) {
+        code = AY3600_KEY_A + (c - 0x01);
+        control = true;
+    } else {
+        g_server.stats.bytes_dropped++;
+        return 0;
+    }
+
+    key_injector_push_keystroke(code, control, shift, now_ms);
+    return 2;
+}
+
+/**
+ * @brief Decode a received chunk and queue the resulting events
+ *
+ * The caller guarantees the injector has two free slots per byte, so no
+ * event is ever dropped here.
+ */
+static int queue_bytes(net_client_t *client, const uint8_t *data, size_t len,
+                       uint32_t now_ms)
+{
+    int queued = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i];
+
+        if (client->frame_pending) {
+            ay3600_key_event_t event = {
+                .key_code = c & NET_KEYBOARD_EVENT_CODE_MASK,
+                .control = (c & NET_KEYBOARD_EVENT_CONTROL) != 0,
+                .shift = (c & NET_KEYBOARD_EVENT_SHIFT) != 0,
+                .pressed = (c & NET_KEYBOARD_EVENT_PRESSED) != 0,
+            };
+            key_injector_push(&event, now_ms);
+            client->frame_pending = false;
+            queued++;
+        } else if (c == NET_KEYBOARD_FRAME_MARKER) {
+            client->frame_pending = true;
+            client->last_was_cr = false;
+        } else if (c < 0x80) {
+            queued += queue_text_byte(client, c, now_ms);
+        } else {
+            g_server.stats.bytes_dropped++;
+        }
+    }
+
+    return queued;
+}
+
+static void accept_clients(void)
+{
+    for (;;) {
+        int fd = accept(g_server.listen_fd, NULL, NULL);
+        if (fd < 0) {
+            return;
+        }
+
+        net_client_t *slot = NULL;
+        for (unsigned i = 0; i < NET_KEYBOARD_MAX_CLIENTS; i++) {
+            if (g_server.clients[i].fd < 0) {
+                slot = &g_server.clients[i];
+                break;
+            }
+        }
+
+        int one = 1;
+        if (!slot || set_nonblocking(fd) < 0 ||
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) < 0) {
+            g_server.stats.rejected++;
+            close(fd);
+            continue;
+        }
+
+        memset(slot, 0, sizeof(*slot));
+        slot->fd = fd;
+        g_server.stats.connections++;
+        LOG_INFO("Client connected");
+    }
+}
+
+int net_keyboard_start(const net_keyboard_config_t *config)
+{
+    if (!config || g_server.listen_fd >= 0) {
+        return -1;
+    }
+
+    memset(&g_server, 0, sizeof(g_server));
+    for (unsigned i = 0; i < NET_KEYBOARD_MAX_CLIENTS; i++) {
+        g_server.clients[i].fd = -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) {
+        g_server.listen_fd = -1;
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(config->port),
+        .sin_addr.s_addr = htonl(config->bind_addr),
+    };
+    socklen_t addr_len = sizeof(addr);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(fd, NET_KEYBOARD_MAX_CLIENTS) < 0 ||
+        set_nonblocking(fd) < 0 ||
+        getsockname(fd, (struct sockaddr *)&addr, &addr_len) < 0) {
+        LOG_WARN("Failed to listen on port %u (errno %d)", config->port, errno);
+        close(fd);
+        g_server.listen_fd = -1;
+        return -1;
+    }
+
+    g_server.listen_fd = fd;
+    g_server.port = ntohs(addr.sin_port);
+    LOG_INFO("Keyboard server listening on port %u", g_server.port);
+    return 0;
+}
+
+void net_keyboard_stop(void)
+{
+    if (g_server.listen_fd < 0) {
+        return;
+    }
+
+    for (unsigned i = 0; i < NET_KEYBOARD_MAX_CLIENTS; i++) {
+        if (g_server.clients[i].fd >= 0) {
+            close_client(&g_server.clients[i]);
+        }
+    }
+    close(g_server.listen_fd);
+    g_server.listen_fd = -1;
+    g_server.port = 0;
+}
+
+uint16_t net_keyboard_port(void)
+{
+    return g_server.port;
+}
+
+int net_keyboard_poll(uint32_t now_ms)
+{
+    uint8_t buf[NET_KEYBOARD_RX_BUDGET];
+    int queued = 0;
+
+    if (g_server.listen_fd < 0) {
+        return -1;
+    }
+
+    accept_clients();
+
+    // Rotate the starting client so a busy connection cannot starve others
+    unsigned start = g_server.next_client;
+    g_server.next_client = (start + 1) % NET_KEYBOARD_MAX_CLIENTS;
+
+    for (unsigned n = 0; n < NET_KEYBOARD_MAX_CLIENTS; n++) {
+        net_client_t *client = &g_server.clients[(start + n) % NET_KEYBOARD_MAX_CLIENTS];
+        if (client->fd < 0) {
+            continue;
+        }
+
+        // Worst case every byte is a text keystroke needing two slots
+        size_t room = key_injector_space() / 2;
+        if (room == 0) {
+            g_server.stats.backpressure++;
+            break;
+        }
+        if (room > sizeof(buf)) {
+            room = sizeof(buf);
+        }
+
+        ssize_t len = recv(client->fd, buf, room, 0);
+        if (len > 0) {
+            g_server.stats.bytes_received += len;
+            queued += queue_bytes(client, buf, (size_t)len, now_ms);
+        } else if (len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            LOG_INFO("Client disconnected");
+            close_client(client);
+        }
+    }
+
+    g_server.stats.events_queued += queued;
+    return queued;
+}
+
+void net_keyboard_get_stats(net_keyboard_stats_t *stats)
+{
+    if (stats) {
+        *stats = g_server.stats;
+    }
+}
@@ -0,0 +1,125 @@
+/**
+ * @file net_keyboard.h
+ * @brief TCP keyboard server
+ *
+ * Accepts keyboard input over TCP and feeds it to the AY-3600 emulator
+ * through the key injector. Each connection may mix two input forms:
+ *
+ * - Raw text: 7-bit ASCII bytes are translated to keystrokes. Letters map
+ *   to their key codes (uppercase adds SHIFT), control characters add
+ *   CONTROL, and CR/LF, ESC, TAB, BS/DEL map to their dedicated keys.
+ *   Bytes without an Apple IIc key are dropped and counted.
+ * - Binary events: the byte NET_KEYBOARD_FRAME_MARKER followed by one
+ *   event byte (bits 0-4 key code, bit 5 CONTROL, bit 6 SHIFT,
+ *   bit 7 pressed).
+ *
+ * The server is non-blocking and is polled from the emulator task. Sockets
+ * have Nagle disabled, each client is read with a fixed per-poll budget,
+ * and no more is read than the injector queue can accept. Excess input
+ * stays in the socket buffer, so TCP flow control throttles a fast sender
+ * and a slow or stalled client never blocks the emulator.
+ */
+
+#ifndef NET_KEYBOARD_H
+#define NET_KEYBOARD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default TCP port
+ */
+#define NET_KEYBOARD_DEFAULT_PORT 6502
+
+/**
+ * @brief Maximum number of simultaneous clients
+ */
+#define NET_KEYBOARD_MAX_CLIENTS 4
+
+/**
+ * @brief Maximum bytes read from one client per poll
+ */
+#define NET_KEYBOARD_RX_BUDGET 64
+
+/**
+ * @brief Binary event frame marker (not valid 7-bit ASCII)
+ */
+#define NET_KEYBOARD_FRAME_MARKER 0xA5
+
+/**
+ * @brief Binary event byte fields
+ */
+#define NET_KEYBOARD_EVENT_CODE_MASK 0x1F  /**< Key code (0-31) */
+#define NET_KEYBOARD_EVENT_CONTROL   0x20  /**< CONTROL modifier */
+#define NET_KEYBOARD_EVENT_SHIFT     0x40  /**< SHIFT modifier */
+#define NET_KEYBOARD_EVENT_PRESSED   0x80  /**< Set on press, clear on release */
+
+/**
+ * @brief Network keyboard configuration
+ */
+typedef struct {
+    uint16_t port;        /**< TCP port (0 selects an ephemeral port) */
+    uint32_t bind_addr;   /**< IPv4 address in host byte order (e.g. INADDR_ANY) */
+} net_keyboard_config_t;
+
+/**
+ * @brief Network keyboard statistics
+ */
+typedef struct {
+    uint32_t connections;       /**< Clients accepted */
+    uint32_t rejected;          /**< Clients refused because all slots were busy */
+    uint32_t bytes_received;    /**< Bytes read from all clients */
+    uint32_t events_queued;     /**< Key events handed to the injector */
+    uint32_t bytes_dropped;     /**< Text bytes with no Apple IIc key */
+    uint32_t backpressure;      /**< Polls where reading was deferred for lack of queue space */
+} net_keyboard_stats_t;
+
+/**
+ * @brief Start the keyboard server
+ *
+ * The key injector must be initialized first.
+ *
+ * @param config Configuration structure
+ * @return 0 on success, negative error code on failure
+ */
+int net_keyboard_start(const net_keyboard_config_t *config);
+
+/**
+ * @brief Stop the server and close all connections
+ */
+void net_keyboard_stop(void);
+
+/**
+ * @brief Get the port the server is listening on
+ *
+ * @return Port number, or 0 if the server is not running
+ */
+uint16_t net_keyboard_port(void);
+
+/**
+ * @brief Service the server without blocking
+ *
+ * Accepts pending connections and queues all complete input read from
+ * clients as one batch. Call from the main loop before
+ * key_injector_process().
+ *
+ * @param now_ms Current time in milliseconds
+ * @return Number of key events queued, or negative error code
+ */
+int net_keyboard_poll(uint32_t now_ms);
+
+/**
+ * @brief Get network keyboard statistics
+ *
+ * @param stats Pointer to structure to fill with statistics
+ */
+void net_keyboard_get_stats(net_keyboard_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_KEYBOARD_H */
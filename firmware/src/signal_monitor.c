@@ -0,0 +1,306 @@
+/**
+ * @file signal_monitor.c
+ * @brief Delta-encoded stream of AY-3600 output transitions
+ */
+
+#include "signal_monitor.h"
+#include "ay3600_output.h"
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#ifndef NATIVE_TEST
+#include "esp_timer.h"
+#define GET_TIME_US()       ((uint64_t)esp_timer_get_time())
+#else
+#include <time.h>
+static uint64_t get_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+#define GET_TIME_US() get_time_us()
+#endif
+
+#define BUFFER_MASK (SIGNAL_MONITOR_BUFFER_SIZE - 1)
+
+/** Keyframe (4) + flags (1) + 32-bit varint (5) + code (1) */
+#define MAX_RECORD_LEN 11
+
+_Static_assert((SIGNAL_MONITOR_BUFFER_SIZE & BUFFER_MASK) == 0,
+               "SIGNAL_MONITOR_BUFFER_SIZE must be a power of two");
+
+/**
+ * @brief Decoder parser states
+ */
+enum {
+    DECODE_HUNT,          /**< Looking for a keyframe marker */
+    DECODE_MAGIC_0,       /**< Expecting first magic byte */
+    DECODE_MAGIC_1,       /**< Expecting second magic byte */
+    DECODE_VERSION,       /**< Expecting version byte */
+    DECODE_FLAGS,         /**< Expecting a record or keyframe */
+    DECODE_DELTA,         /**< Inside the time delta varint */
+    DECODE_CODE,          /**< Expecting the key code byte */
+};
+
+static uint64_t default_clock_us(void)
+{
+    return GET_TIME_US();
+}
+
+int signal_monitor_init(signal_monitor_t *monitor, const signal_monitor_config_t *config)
+{
+    if (!monitor || !config || !config->write) {
+        return -1;
+    }
+
+    memset(monitor, 0, sizeof(*monitor));
+    monitor->config = *config;
+    if (!monitor->config.clock_us) {
+        monitor->config.clock_us = default_clock_us;
+    }
+    monitor->last_us = monitor->config.clock_us();
+    monitor->need_keyframe = true;
+    return 0;
+}
+
+void signal_monitor_sink(const ay3600_output_t *output, uint16_t changed, void *ctx)
+{
+    signal_monitor_t *monitor = ctx;
+    uint8_t record[MAX_RECORD_LEN];
+    size_t len = 0;
+    uint64_t now = monitor->config.clock_us();
+    uint64_t elapsed = now - monitor->last_us;
+    uint32_t delta = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+    bool keyframe = monitor->need_keyframe ||
+                    monitor->since_keyframe >= SIGNAL_MONITOR_KEYFRAME_INTERVAL;
+    uint8_t flags = 0;
+
+    (void)changed;
+
+    if (keyframe) {
+        record[len++] = SIGNAL_MONITOR_KEYFRAME;
+        record[len++] = SIGNAL_MONITOR_MAGIC_0;
+        record[len++] = SIGNAL_MONITOR_MAGIC_1;
+        record[len++] = SIGNAL_MONITOR_VERSION;
+    }
+
+    if (output->control) {
+        flags |= SIGNAL_MONITOR_FLAG_CONTROL;
+    }
+    if (output->shift) {
+        flags |= SIGNAL_MONITOR_FLAG_SHIFT;
+    }
+    if (output->any_key) {
+        flags |= SIGNAL_MONITOR_FLAG_ANY_KEY;
+    }
+    if (output->strobe) {
+        flags |= SIGNAL_MONITOR_FLAG_STROBE;
+    }
+    if (keyframe || output->key_code != monitor->last_code) {
+        flags |= SIGNAL_MONITOR_FLAG_CODE;
+    }
+    if (monitor->overflowed) {
+        flags |= SIGNAL_MONITOR_FLAG_OVERFLOW;
+    }
+    record[len++] = flags;
+
+    do {
+        uint8_t byte = delta & 0x7F;
+        delta >>= 7;
+        record[len++] = delta ? (byte | 0x80) : byte;
+    } while (delta);
+
+    if (flags & SIGNAL_MONITOR_FLAG_CODE) {
+        record[len++] = output->key_code & AY3600_PINS_KEY_CODE;
+    }
+
+    // Only the consumer moves tail; a stale value just underestimates space
+    uint32_t head = monitor->head;
+    uint32_t tail = __atomic_load_n(&monitor->tail, __ATOMIC_ACQUIRE);
+    if (SIGNAL_MONITOR_BUFFER_SIZE - (head - tail) < len) {
+        // Deltas stay relative to the last record the decoder will see
+        monitor->overflowed = true;
+        monitor->need_keyframe = true;
+        monitor->stats.dropped++;
+        return;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        monitor->buffer[(head + i) & BUFFER_MASK] = record[i];
+    }
+    __atomic_store_n(&monitor->head, head + (uint32_t)len, __ATOMIC_RELEASE);
+
+    monitor->last_us = now;
+    monitor->last_code = output->key_code & AY3600_PINS_KEY_CODE;
+    monitor->since_keyframe = keyframe ? 0 : monitor->since_keyframe + 1;
+    monitor->need_keyframe = false;
+    monitor->overflowed = false;
+    monitor->stats.records++;
+}
+
+int signal_monitor_flush(signal_monitor_t *monitor)
+{
+    uint32_t head = __atomic_load_n(&monitor->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = monitor->tail;
+    int sent = 0;
+
+    while (tail != head) {
+        uint32_t offset = tail & BUFFER_MASK;
+        uint32_t chunk = head - tail;
+
+        // Contiguous run up to the end of the buffer
+        if (chunk > SIGNAL_MONITOR_BUFFER_SIZE - offset) {
+            chunk = SIGNAL_MONITOR_BUFFER_SIZE - offset;
+        }
+
+        int n = monitor->config.write(monitor->config.write_ctx,
+                                      &monitor->buffer[offset], chunk);
+        if (n < 0) {
+            monitor->stats.write_errors++;
+            __atomic_store_n(&monitor->tail, tail, __ATOMIC_RELEASE);
+            return -1;
+        }
+
+        tail += (uint32_t)n;
+        sent += n;
+        monitor->stats.bytes_sent += (uint32_t)n;
+        if ((uint32_t)n < chunk) {
+            break;
+        }
+    }
+
+    __atomic_store_n(&monitor->tail, tail, __ATOMIC_RELEASE);
+    return sent;
+}
+
+size_t signal_monitor_pending(const signal_monitor_t *monitor)
+{
+    return __atomic_load_n(&monitor->head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&monitor->tail, __ATOMIC_ACQUIRE);
+}
+
+void signal_monitor_get_stats(const signal_monitor_t *monitor, signal_monitor_stats_t *stats)
+{
+    if (stats) {
+        *stats = monitor->stats;
+    }
+}
+
+int signal_monitor_fd_write(void *ctx, const uint8_t *data, size_t len)
+{
+    int fd = (int)(intptr_t)ctx;
+    ssize_t n = write(fd, data, len);
+
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+    return (int)n;
+}
+
+void signal_monitor_decoder_init(signal_monitor_decoder_t *decoder)
+{
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->state = DECODE_HUNT;
+}
+
+/**
+ * @brief Drop malformed input and search for the next keyframe
+ */
+static void decoder_resync(signal_monitor_decoder_t *decoder)
+{
+    decoder->errors++;
+    decoder->have_code = false;
+    decoder->state = DECODE_HUNT;
+}
+
+static void decoder_emit(signal_monitor_decoder_t *decoder, signal_monitor_event_t *event)
+{
+    uint8_t flags = decoder->flags;
+
+    event->time_us = decoder->time_us;
+    event->output.key_code = decoder->code;
+    event->output.control = (flags & SIGNAL_MONITOR_FLAG_CONTROL) != 0;
+    event->output.shift = (flags & SIGNAL_MONITOR_FLAG_SHIFT) != 0;
+    event->output.any_key = (flags & SIGNAL_MONITOR_FLAG_ANY_KEY) != 0;
+    event->output.strobe = (flags & SIGNAL_MONITOR_FLAG_STROBE) != 0;
+    event->overflow = (flags & SIGNAL_MONITOR_FLAG_OVERFLOW) != 0;
+    decoder->state = DECODE_FLAGS;
+}
+
+int signal_monitor_decode(signal_monitor_decoder_t *decoder, uint8_t byte,
+                          signal_monitor_event_t *event)
+{
+    switch (decoder->state) {
+        case DECODE_HUNT:
+            if (byte == SIGNAL_MONITOR_KEYFRAME) {
+                decoder->state = DECODE_MAGIC_0;
+            }
+            break;
+
+        case DECODE_MAGIC_0:
+            if (byte == SIGNAL_MONITOR_MAGIC_0) {
+                decoder->state = DECODE_MAGIC_1;
+            } else if (byte != SIGNAL_MONITOR_KEYFRAME) {
+                decoder->state = DECODE_HUNT;
+            }
+            break;
+
+        case DECODE_MAGIC_1:
+            decoder->state = (byte == SIGNAL_MONITOR_MAGIC_1) ? DECODE_VERSION : DECODE_HUNT;
+            break;
+
+        case DECODE_VERSION:
+            decoder->state = (byte == SIGNAL_MONITOR_VERSION) ? DECODE_FLAGS : DECODE_HUNT;
+            break;
+
+        case DECODE_FLAGS:
+            if (byte == SIGNAL_MONITOR_KEYFRAME) {
+                decoder->state = DECODE_MAGIC_0;
+            } else if (byte & 0xC0) {
+                decoder_resync(decoder);
+            } else {
+                decoder->flags = byte;
+                decoder->delta = 0;
+                decoder->shift = 0;
+                decoder->state = DECODE_DELTA;
+            }
+            break;
+
+        case DECODE_DELTA:
+            decoder->delta |= (uint32_t)(byte & 0x7F) << decoder->shift;
+            if (byte & 0x80) {
+                decoder->shift += 7;
+                if (decoder->shift > 28) {
+                    decoder_resync(decoder);
+                }
+                break;
+            }
+            decoder->time_us += decoder->delta;
+            if (decoder->flags & SIGNAL_MONITOR_FLAG_CODE) {
+                decoder->state = DECODE_CODE;
+            } else if (!decoder->have_code) {
+                decoder_resync(decoder);
+            } else {
+                decoder_emit(decoder, event);
+                return 1;
+            }
+            break;
+
+        case DECODE_CODE:
+            if (byte > AY3600_PINS_KEY_CODE) {
+                decoder_resync(decoder);
+                break;
+            }
+            decoder->code = byte;
+            decoder->have_code = true;
+            decoder_emit(decoder, event);
+            return 1;
+
+        default:
+            decoder_resync(decoder);
+            break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file signal_monitor.h
+ * @brief Delta-encoded stream of AY-3600 output transitions
+ *
+ * An output sink that encodes each emulator update into a few bytes and
+ * queues them in a lock-free ring buffer. The sink only copies bytes, so
+ * it adds almost nothing to the GPIO path; signal_monitor_flush() hands the
+ * queued bytes to a transport (UART on the device, a pipe or file
+ * descriptor in the native build) from a less critical context.
+ *
+ * Stream format (all multi-byte integers are LEB128 varints):
+ *
+ *     keyframe := 0xFF 'A' 'Y' version
+ *     record   := flags delta_us [code]
+ *
+ * flags bit 0-2 carry the new CONTROL, SHIFT and ANY-KEY levels, bit 3 is
+ * set when KSTRB pulsed, bit 4 when a key code byte follows, and bit 5 when
+ * records were dropped before this one. Bits 6-7 are zero, so 0xFF never
+ * starts a record. delta_us is the time since the previous record. A
+ * keyframe is sent at stream start, after an overflow and periodically, and
+ * the record after a keyframe always carries the key code, so a decoder can
+ * join the stream at any point.
+ */
+
+#ifndef SIGNAL_MONITOR_H
+#define SIGNAL_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "ay3600_emulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Ring buffer size in bytes (power of two)
+ */
+#define SIGNAL_MONITOR_BUFFER_SIZE 1024
+
+/**
+ * @brief Records between periodic keyframes
+ */
+#define SIGNAL_MONITOR_KEYFRAME_INTERVAL 64
+
+/**
+ * @brief Stream format version carried in keyframes
+ */
+#define SIGNAL_MONITOR_VERSION 1
+
+/**
+ * @brief Keyframe marker and magic bytes
+ */
+#define SIGNAL_MONITOR_KEYFRAME   0xFF
+#define SIGNAL_MONITOR_MAGIC_0    'A'
+#define SIGNAL_MONITOR_MAGIC_1    'Y'
+
+/**
+ * @brief Record flag bits
+ */
+#define SIGNAL_MONITOR_FLAG_CONTROL  0x01  /**< CONTROL level */
+#define SIGNAL_MONITOR_FLAG_SHIFT    0x02  /**< SHIFT level */
+#define SIGNAL_MONITOR_FLAG_ANY_KEY  0x04  /**< ANY-KEY level */
+#define SIGNAL_MONITOR_FLAG_STROBE   0x08  /**< KSTRB pulsed */
+#define SIGNAL_MONITOR_FLAG_CODE     0x10  /**< Key code byte follows */
+#define SIGNAL_MONITOR_FLAG_OVERFLOW 0x20  /**< Records were dropped */
+
+/**
+ * @brief Transport write hook
+ *
+ * Must not block. Returns the number of bytes accepted (possibly fewer
+ * than len), or -1 on error.
+ */
+typedef int (*signal_monitor_write_t)(void *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Microsecond clock used to timestamp records
+ */
+typedef uint64_t (*signal_monitor_clock_t)(void);
+
+/**
+ * @brief Signal monitor configuration
+ */
+typedef struct {
+    signal_monitor_write_t write;   /**< Transport hook */
+    void *write_ctx;                /**< Passed to write */
+    signal_monitor_clock_t clock_us; /**< Timestamp source (NULL = system clock) */
+} signal_monitor_config_t;
+
+/**
+ * @brief Signal monitor statistics
+ */
+typedef struct {
+    uint32_t records;         /**< Records queued */
+    uint32_t dropped;         /**< Records lost to a full buffer */
+    uint32_t bytes_sent;      /**< Bytes accepted by the transport */
+    uint32_t write_errors;    /**< Transport errors */
+} signal_monitor_stats_t;
+
+/**
+ * @brief Signal monitor state
+ *
+ * The sink (producer) and signal_monitor_flush() (consumer) may run on
+ * different tasks; each side only advances its own index.
+ */
+typedef struct {
+    signal_monitor_config_t config;           /**< Configuration */
+    uint8_t buffer[SIGNAL_MONITOR_BUFFER_SIZE]; /**< Encoded bytes */
+    uint32_t head;                            /**< Producer index */
+    uint32_t tail;                            /**< Consumer index */
+    uint64_t last_us;                         /**< Time of the previous record */
+    uint8_t last_code;                        /**< Key code of the previous record */
+    uint8_t since_keyframe;                   /**< Records since the last keyframe */
+    bool need_keyframe;                       /**< Next record starts with a keyframe */
+    bool overflowed;                          /**< Records dropped since last record */
+    signal_monitor_stats_t stats;             /**< Statistics */
+} signal_monitor_t;
+
+/**
+ * @brief Initialize a signal monitor
+ *
+ * @param monitor Monitor to initialize
+ * @param config Configuration (copied)
+ * @return 0 on success, -1 if config or its write hook is missing
+ */
+int signal_monitor_init(signal_monitor_t *monitor, const signal_monitor_config_t *config);
+
+/**
+ * @brief Output sink entry point
+ *
+ * Register with ay3600_add_sink(signal_monitor_sink, AY3600_PINS_ALL, monitor).
+ */
+void signal_monitor_sink(const ay3600_output_t *output, uint16_t changed, void *ctx);
+
+/**
+ * @brief Send queued bytes to the transport
+ *
+ * @param monitor Signal monitor
+ * @return Number of bytes sent, or -1 on transport error
+ */
+int signal_monitor_flush(signal_monitor_t *monitor);
+
+/**
+ * @brief Number of bytes waiting to be flushed
+ */
+size_t signal_monitor_pending(const signal_monitor_t *monitor);
+
+/**
+ * @brief Get signal monitor statistics
+ */
+void signal_monitor_get_stats(const signal_monitor_t *monitor, signal_monitor_stats_t *stats);
+
+/**
+ * @brief Write hook for a non-blocking file descriptor
+ *
+ * The descriptor is passed as the context, cast with (void *)(intptr_t)fd.
+ */
+int signal_monitor_fd_write(void *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Decoded output transition
+ */
+typedef struct {
+    uint64_t time_us;          /**< Time since the stream was joined */
+    ay3600_output_t output;    /**< Output state; strobe marks a KSTRB pulse */
+    bool overflow;             /**< Transitions were lost before this one */
+} signal_monitor_event_t;
+
+/**
+ * @brief Streaming decoder state
+ */
+typedef struct {
+    uint8_t state;             /**< Parser state */
+    uint8_t flags;             /**< Flags of the record being parsed */
+    uint8_t shift;             /**< Varint bit position */
+    uint32_t delta;            /**< Varint being parsed */
+    bool have_code;            /**< A key code has been seen since joining */
+    uint64_t time_us;          /**< Accumulated time */
+    uint8_t code;              /**< Current key code */
+    uint32_t errors;           /**< Malformed input resynchronizations */
+} signal_monitor_decoder_t;
+
+/**
+ * @brief Reset a decoder to search for a keyframe
+ */
+void signal_monitor_decoder_init(signal_monitor_decoder_t *decoder);
+
+/**
+ * @brief Feed one byte to the decoder
+ *
+ * @param decoder Decoder state
+ * @param byte Next stream byte
+ * @param event Filled when a record completes
+ * @return 1 if event was filled, 0 otherwise
+ */
+int signal_monitor_decode(signal_monitor_decoder_t *decoder, uint8_t byte,
+                          signal_monitor_event_t *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIGNAL_MONITOR_H */
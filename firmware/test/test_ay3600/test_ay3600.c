@@ -189,6 +189,7 @@ void test_ay3600_handle_event_release(void)
 
     // Then release
     ay3600_key_event_t release_event = {
+        .key_code = 0x05,
         .pressed = false,
     };
     int result = ay3600_handle_event(&release_event);
@@ -305,6 +306,106 @@ void test_ay3600_key_code_masking(void)
     TEST_ASSERT_EQUAL(0x1F, last_output.key_code);
 }
 
+// Virtual clock for timing tests
+static uint32_t virtual_now;
+
+static uint32_t virtual_clock(void)
+{
+    return virtual_now;
+}
+
+// Test that releasing a rolled-over key keeps the newer key held
+void test_ay3600_release_rolled_over_key(void)
+{
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = 0,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    ay3600_init(&config);
+
+    ay3600_key_event_t event = { .key_code = 0x01, .pressed = true };
+    ay3600_handle_event(&event);
+    event.key_code = 0x02;
+    ay3600_handle_event(&event);
+
+    // Key 0x01 comes up after 0x02 went down
+    event.key_code = 0x01;
+    event.pressed = false;
+    TEST_ASSERT_EQUAL(0, ay3600_handle_event(&event));
+    TEST_ASSERT_TRUE(last_output.any_key);
+    TEST_ASSERT_EQUAL(0x02, last_output.key_code);
+
+    event.key_code = 0x02;
+    TEST_ASSERT_EQUAL(0, ay3600_handle_event(&event));
+    TEST_ASSERT_FALSE(last_output.any_key);
+}
+
+// Test that a zero repeat rate disables auto-repeat
+void test_ay3600_repeat_rate_zero(void)
+{
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = 0,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 0,
+        .clock_ms = virtual_clock,
+    };
+    uint32_t deadline;
+    ay3600_stats_t stats;
+
+    virtual_now = 1000;
+    ay3600_init(&config);
+    ay3600_press_key(0x03, false, false);
+    TEST_ASSERT_EQUAL(1, callback_count);
+    TEST_ASSERT_EQUAL(-1, ay3600_next_deadline(&deadline));
+
+    virtual_now += 5000;
+    ay3600_process();
+    TEST_ASSERT_EQUAL(1, callback_count);
+    TEST_ASSERT_TRUE(last_output.any_key);
+
+    ay3600_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.total_repeats);
+}
+
+// Test debounce and repeat timing against a virtual clock
+void test_ay3600_virtual_clock(void)
+{
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = 20,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+        .clock_ms = virtual_clock,
+    };
+    uint32_t deadline;
+
+    virtual_now = 0xFFFFFFF0UL;  // Crosses the 32-bit wrap
+    ay3600_init(&config);
+    ay3600_press_key(0x04, false, false);
+    TEST_ASSERT_EQUAL(0, ay3600_next_deadline(&deadline));
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)(0xFFFFFFF0UL + 20), deadline);
+
+    virtual_now += 19;
+    ay3600_process();
+    TEST_ASSERT_EQUAL(0, callback_count);
+
+    virtual_now += 1;
+    ay3600_process();
+    TEST_ASSERT_EQUAL(1, callback_count);
+    TEST_ASSERT_TRUE(last_output.strobe);
+
+    virtual_now += 500;
+    ay3600_process();
+    TEST_ASSERT_EQUAL(2, callback_count);
+
+    virtual_now += 50;
+    ay3600_process();
+    TEST_ASSERT_EQUAL(3, callback_count);
+}
+
 // Main test runner
 int main(void)
 {
@@ -339,6 +440,9 @@ int main(void)
 
     // Edge case tests
     RUN_TEST(test_ay3600_key_code_masking);
+    RUN_TEST(test_ay3600_release_rolled_over_key);
+    RUN_TEST(test_ay3600_repeat_rate_zero);
+    RUN_TEST(test_ay3600_virtual_clock);
 
     return UNITY_END();
 }
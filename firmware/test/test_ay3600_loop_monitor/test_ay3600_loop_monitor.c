@@ -0,0 +1,172 @@
+/**
+ * @file test_ay3600_loop_monitor.c
+ * @brief Unit tests for the main loop jitter and overrun monitor
+ */
+
+#include "unity.h"
+#include "ay3600_emulator.h"
+#include "ay3600_loop_monitor.h"
+#include <time.h>
+
+// Test fixture data
+static ay3600_loop_monitor_t monitor;
+
+static void sleep_us(long us)
+{
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+void setUp(void)
+{
+    ay3600_loop_monitor_init(&monitor, 0);
+}
+
+void tearDown(void)
+{
+}
+
+// Test: Default threshold is selected for zero
+void test_loop_monitor_default_threshold(void)
+{
+    TEST_ASSERT_EQUAL(AY3600_OVERRUN_THRESHOLD_US, monitor.overrun_threshold_us);
+    TEST_ASSERT_EQUAL(0, monitor.overruns);
+    TEST_ASSERT_EQUAL(0, monitor.interval_us.count);
+}
+
+// Test: First call records a duration but no interval
+void test_loop_monitor_first_call(void)
+{
+    ay3600_loop_monitor_begin(&monitor, 1000);
+    ay3600_loop_monitor_end(&monitor, 1010);
+
+    TEST_ASSERT_EQUAL(0, monitor.interval_us.count);
+    TEST_ASSERT_EQUAL(1, monitor.duration_us.count);
+    TEST_ASSERT_EQUAL(10, monitor.worst_duration_us);
+}
+
+// Test: Regular intervals are recorded without overruns
+void test_loop_monitor_regular_intervals(void)
+{
+    for (uint64_t t = 0; t < 100000; t += 1000) {
+        ay3600_loop_monitor_begin(&monitor, t);
+        ay3600_loop_monitor_end(&monitor, t + 5);
+    }
+
+    TEST_ASSERT_EQUAL(99, monitor.interval_us.count);
+    TEST_ASSERT_EQUAL(1000, monitor.worst_interval_us);
+    TEST_ASSERT_EQUAL(0, monitor.overruns);
+    TEST_ASSERT_EQUAL(0, monitor.slow_calls);
+    TEST_ASSERT_EQUAL(1000, monitor.interval_us.min);
+    TEST_ASSERT_EQUAL(1000, monitor.interval_us.max);
+}
+
+// Test: Late calls are counted as overruns and tracked as worst case
+void test_loop_monitor_overrun(void)
+{
+    ay3600_loop_monitor_begin(&monitor, 0);
+    ay3600_loop_monitor_end(&monitor, 5);
+    ay3600_loop_monitor_begin(&monitor, 1000);
+    ay3600_loop_monitor_end(&monitor, 1005);
+    ay3600_loop_monitor_begin(&monitor, 7000);   // 6 ms late tick
+    ay3600_loop_monitor_end(&monitor, 7005);
+    ay3600_loop_monitor_begin(&monitor, 9000);   // exactly at threshold
+    ay3600_loop_monitor_end(&monitor, 9005);
+
+    TEST_ASSERT_EQUAL(1, monitor.overruns);
+    TEST_ASSERT_EQUAL(6000, monitor.worst_interval_us);
+}
+
+// Test: Slow calls are counted separately from late ones
+void test_loop_monitor_slow_call(void)
+{
+    ay3600_loop_monitor_init(&monitor, 500);
+
+    ay3600_loop_monitor_begin(&monitor, 0);
+    ay3600_loop_monitor_end(&monitor, 800);
+
+    TEST_ASSERT_EQUAL(1, monitor.slow_calls);
+    TEST_ASSERT_EQUAL(800, monitor.worst_duration_us);
+    TEST_ASSERT_EQUAL(0, monitor.overruns);
+}
+
+// Test: Resync drops the gap across a pause
+void test_loop_monitor_resync(void)
+{
+    ay3600_loop_monitor_begin(&monitor, 0);
+    ay3600_loop_monitor_end(&monitor, 5);
+    ay3600_loop_monitor_resync(&monitor);
+    ay3600_loop_monitor_begin(&monitor, 5000000);
+    ay3600_loop_monitor_end(&monitor, 5000005);
+
+    TEST_ASSERT_EQUAL(0, monitor.overruns);
+    TEST_ASSERT_EQUAL(0, monitor.interval_us.count);
+}
+
+// Test: Reset clears measurements but keeps the threshold
+void test_loop_monitor_reset(void)
+{
+    ay3600_loop_monitor_init(&monitor, 300);
+    ay3600_loop_monitor_begin(&monitor, 0);
+    ay3600_loop_monitor_end(&monitor, 5);
+    ay3600_loop_monitor_begin(&monitor, 1000);
+    ay3600_loop_monitor_end(&monitor, 1005);
+    TEST_ASSERT_EQUAL(1, monitor.overruns);
+
+    ay3600_loop_monitor_reset(&monitor);
+
+    TEST_ASSERT_EQUAL(300, monitor.overrun_threshold_us);
+    TEST_ASSERT_EQUAL(0, monitor.overruns);
+    TEST_ASSERT_EQUAL(0, monitor.duration_us.count);
+    TEST_ASSERT_EQUAL(0, monitor.worst_interval_us);
+}
+
+// Test: Emulator reports late ay3600_process() calls through its stats
+void test_loop_monitor_emulator_stats(void)
+{
+    ay3600_config_t config = {
+        .output_callback = NULL,
+        .debounce_ms = 5,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+        .overrun_threshold_us = 3000,
+    };
+    ay3600_stats_t stats;
+    ay3600_loop_monitor_t loop;
+
+    TEST_ASSERT_EQUAL(0, ay3600_init(&config));
+
+    ay3600_process();
+    ay3600_process();
+    sleep_us(10000);
+    ay3600_process();
+
+    ay3600_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.process_overruns);
+    TEST_ASSERT_TRUE(stats.max_process_interval_us >= 10000);
+    TEST_ASSERT_TRUE(stats.max_process_duration_us < stats.max_process_interval_us);
+
+    ay3600_get_loop_monitor(&loop);
+    TEST_ASSERT_EQUAL(3000, loop.overrun_threshold_us);
+    TEST_ASSERT_EQUAL(2, loop.interval_us.count);
+    TEST_ASSERT_EQUAL(3, loop.duration_us.count);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    // Monitor tests
+    RUN_TEST(test_loop_monitor_default_threshold);
+    RUN_TEST(test_loop_monitor_first_call);
+    RUN_TEST(test_loop_monitor_regular_intervals);
+    RUN_TEST(test_loop_monitor_overrun);
+    RUN_TEST(test_loop_monitor_slow_call);
+    RUN_TEST(test_loop_monitor_resync);
+    RUN_TEST(test_loop_monitor_reset);
+
+    // Emulator integration tests
+    RUN_TEST(test_loop_monitor_emulator_stats);
+
+    return UNITY_END();
+}
@@ -0,0 +1,505 @@
+/**
+ * @file test_ay3600_snapshot.c
+ * @brief Unit tests for emulator snapshot and restore
+ */
+
+#include "unity.h"
+#include "ay3600_emulator.h"
+#include "crc32.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Test fixture data
+static ay3600_output_t last_output;
+static int callback_count;
+static int strobe_count;
+
+static void test_callback(const ay3600_output_t *output)
+{
+    last_output = *output;
+    callback_count++;
+    if (output->strobe) {
+        strobe_count++;
+    }
+}
+
+static void sleep_ms(long ms)
+{
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000 };
+    nanosleep(&ts, NULL);
+}
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static uint32_t virtual_now;
+
+static uint32_t virtual_clock(void)
+{
+    return virtual_now;
+}
+
+static void init_virtual_emulator(uint16_t repeat_delay_ms)
+{
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = 0,
+        .repeat_delay_ms = repeat_delay_ms,
+        .repeat_rate_ms = 50,
+        .clock_ms = virtual_clock,
+    };
+    TEST_ASSERT_EQUAL(0, ay3600_init(&config));
+}
+
+static void run_until(uint32_t end)
+{
+    while ((int32_t)(end - virtual_now) > 0) {
+        virtual_now++;
+        ay3600_process();
+    }
+}
+
+static void init_emulator(uint16_t debounce_ms, uint16_t repeat_delay_ms)
+{
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = debounce_ms,
+        .repeat_delay_ms = repeat_delay_ms,
+        .repeat_rate_ms = 50,
+    };
+    TEST_ASSERT_EQUAL(0, ay3600_init(&config));
+}
+
+void setUp(void)
+{
+    memset(&last_output, 0, sizeof(last_output));
+    callback_count = 0;
+    strobe_count = 0;
+}
+
+void tearDown(void)
+{
+    ay3600_reset();
+}
+
+// Test: Snapshot has a fixed, versioned, checksummed layout
+void test_snapshot_save_header(void)
+{
+    ay3600_snapshot_t snapshot;
+
+    init_emulator(0, 500);
+    TEST_ASSERT_EQUAL(-1, ay3600_snapshot_save(NULL));
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+
+    TEST_ASSERT_EQUAL_HEX32(AY3600_SNAPSHOT_MAGIC, snapshot.magic);
+    TEST_ASSERT_EQUAL(AY3600_SNAPSHOT_VERSION, snapshot.version);
+    TEST_ASSERT_EQUAL(40, snapshot.size);
+    TEST_ASSERT_EQUAL(0, snapshot.flags & AY3600_SNAPSHOT_DEADLINE);
+}
+
+// Test: A held key survives a re-initialization without a second strobe
+void test_snapshot_held_key(void)
+{
+    ay3600_snapshot_t snapshot;
+    ay3600_stats_t stats;
+
+    init_emulator(0, 500);
+    ay3600_press_key(0x0C, true, true);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+
+    // Simulate a reset
+    init_emulator(0, 500);
+    callback_count = 0;
+    strobe_count = 0;
+
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_restore(&snapshot));
+    TEST_ASSERT_EQUAL(1, callback_count);
+    TEST_ASSERT_EQUAL(0, strobe_count);
+    TEST_ASSERT_EQUAL(0x0C, last_output.key_code);
+    TEST_ASSERT_TRUE(last_output.control);
+    TEST_ASSERT_TRUE(last_output.shift);
+    TEST_ASSERT_TRUE(last_output.any_key);
+
+    ay3600_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.total_keypresses);
+
+    // Release continues cleanly
+    ay3600_release_key();
+    TEST_ASSERT_FALSE(last_output.any_key);
+    TEST_ASSERT_EQUAL(-1, ay3600_next_deadline(&(uint32_t){0}));
+}
+
+// Test: Pending deadline is rebased so the paused time does not count
+void test_snapshot_rebases_deadline(void)
+{
+    ay3600_snapshot_t snapshot;
+    uint32_t deadline;
+
+    init_emulator(0, 200);
+    ay3600_press_key(0x01, false, false);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+    TEST_ASSERT_TRUE(snapshot.flags & AY3600_SNAPSHOT_DEADLINE);
+    TEST_ASSERT_TRUE(snapshot.deadline_in_ms <= 200);
+    TEST_ASSERT_TRUE(snapshot.deadline_in_ms >= 190);
+
+    // Asleep for longer than the repeat delay
+    sleep_ms(300);
+    init_emulator(0, 200);
+    strobe_count = 0;
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_restore(&snapshot));
+
+    // The input source confirms the key is still down
+    TEST_ASSERT_EQUAL(0, ay3600_press_key(0x01, false, false));
+    ay3600_process();
+    TEST_ASSERT_EQUAL(0, strobe_count);
+
+    TEST_ASSERT_EQUAL(0, ay3600_next_deadline(&deadline));
+    TEST_ASSERT_TRUE((int32_t)(deadline - now_ms()) >= 180);
+
+    // The repeat still arrives on schedule
+    sleep_ms(220);
+    ay3600_process();
+    TEST_ASSERT_EQUAL(1, strobe_count);
+    TEST_ASSERT_EQUAL(0x01, last_output.key_code);
+}
+
+// Test: A key caught in debounce completes after restore
+void test_snapshot_during_debounce(void)
+{
+    ay3600_snapshot_t snapshot;
+
+    init_emulator(30, 500);
+    ay3600_press_key(0x09, false, true);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+    TEST_ASSERT_FALSE(snapshot.flags & AY3600_SNAPSHOT_OUT_ANY_KEY);
+
+    init_emulator(30, 500);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_restore(&snapshot));
+    TEST_ASSERT_FALSE(last_output.any_key);
+    TEST_ASSERT_EQUAL(0, ay3600_press_key(0x09, false, true));
+
+    sleep_ms(40);
+    ay3600_process();
+    TEST_ASSERT_EQUAL(1, strobe_count);
+    TEST_ASSERT_EQUAL(0x09, last_output.key_code);
+    TEST_ASSERT_TRUE(last_output.shift);
+}
+
+// Test: Timing settings changed at runtime are carried over
+void test_snapshot_restores_settings(void)
+{
+    ay3600_snapshot_t snapshot;
+    ay3600_config_t config;
+
+    init_emulator(20, 500);
+    ay3600_set_timing(5, 300, 40);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+
+    init_emulator(20, 500);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_restore(&snapshot));
+    ay3600_get_config(&config);
+    TEST_ASSERT_EQUAL(5, config.debounce_ms);
+    TEST_ASSERT_EQUAL(300, config.repeat_delay_ms);
+    TEST_ASSERT_EQUAL(40, config.repeat_rate_ms);
+    TEST_ASSERT_EQUAL_PTR(test_callback, config.output_callback);
+}
+
+// Test: Corrupt or foreign snapshots are rejected without side effects
+void test_snapshot_rejects_invalid(void)
+{
+    ay3600_snapshot_t snapshot, bad;
+
+    init_emulator(0, 500);
+    ay3600_press_key(0x03, false, false);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+    ay3600_release_key();
+    callback_count = 0;
+
+    TEST_ASSERT_EQUAL(-1, ay3600_snapshot_restore(NULL));
+
+    bad = snapshot;
+    bad.key_code ^= 0x01;
+    TEST_ASSERT_EQUAL(-1, ay3600_snapshot_restore(&bad));
+
+    bad = snapshot;
+    bad.version++;
+    TEST_ASSERT_EQUAL(-1, ay3600_snapshot_restore(&bad));
+
+    bad = snapshot;
+    bad.magic = 0;
+    TEST_ASSERT_EQUAL(-1, ay3600_snapshot_restore(&bad));
+
+    memset(&bad, 0xA5, sizeof(bad));
+    TEST_ASSERT_EQUAL(-1, ay3600_snapshot_restore(&bad));
+
+    TEST_ASSERT_EQUAL(0, callback_count);
+    TEST_ASSERT_FALSE(last_output.any_key);
+}
+
+// Test: The gap across a restore is not reported as a loop overrun
+void test_snapshot_resyncs_loop_monitor(void)
+{
+    ay3600_snapshot_t snapshot;
+    ay3600_stats_t stats;
+
+    init_emulator(0, 500);
+    ay3600_process();
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+    sleep_ms(10);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_restore(&snapshot));
+    ay3600_process();
+
+    ay3600_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.process_overruns);
+}
+
+// Test: A resumed key nobody confirms is released without repeating
+void test_snapshot_unconfirmed_key_released(void)
+{
+    ay3600_snapshot_t snapshot;
+
+    virtual_now = 1000;
+    init_virtual_emulator(100);
+    ay3600_press_key(0x0A, false, false);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+
+    // The key came up while the firmware was down
+    init_virtual_emulator(100);
+    strobe_count = 0;
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_restore(&snapshot));
+    TEST_ASSERT_TRUE(last_output.any_key);
+
+    // No repeats while waiting, even past the repeat delay
+    run_until(virtual_now + AY3600_RESUME_CONFIRM_MS - 1);
+    TEST_ASSERT_EQUAL(0, strobe_count);
+    TEST_ASSERT_TRUE(last_output.any_key);
+
+    run_until(virtual_now + 1);
+    TEST_ASSERT_EQUAL(0, strobe_count);
+    TEST_ASSERT_FALSE(last_output.any_key);
+    TEST_ASSERT_EQUAL(-1, ay3600_next_deadline(&(uint32_t){0}));
+}
+
+// Test: A confirmed resumed key repeats on its original schedule
+void test_snapshot_confirmed_key_repeats(void)
+{
+    ay3600_snapshot_t snapshot;
+    uint32_t restored_at;
+
+    virtual_now = 1000;
+    init_virtual_emulator(100);
+    ay3600_press_key(0x0A, false, false);
+    run_until(1040);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+    TEST_ASSERT_EQUAL(60, snapshot.deadline_in_ms);
+
+    init_virtual_emulator(100);
+    strobe_count = 0;
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_restore(&snapshot));
+    restored_at = virtual_now;
+
+    // Confirmation does not strobe
+    run_until(virtual_now + 10);
+    TEST_ASSERT_EQUAL(0, ay3600_press_key(0x0A, false, false));
+    TEST_ASSERT_EQUAL(0, strobe_count);
+
+    run_until(restored_at + 59);
+    TEST_ASSERT_EQUAL(0, strobe_count);
+    run_until(restored_at + 60);
+    TEST_ASSERT_EQUAL(1, strobe_count);
+
+    // And a snapshot taken while waiting keeps the original deadline
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_restore(&snapshot));
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+    TEST_ASSERT_EQUAL(60, snapshot.deadline_in_ms);
+}
+
+// Test: A different key during the wait replaces the resumed key
+void test_snapshot_other_key_ends_wait(void)
+{
+    ay3600_snapshot_t snapshot;
+
+    virtual_now = 1000;
+    init_virtual_emulator(100);
+    ay3600_press_key(0x0A, false, false);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save(&snapshot));
+
+    init_virtual_emulator(100);
+    strobe_count = 0;
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_restore(&snapshot));
+    TEST_ASSERT_EQUAL(0, ay3600_press_key(0x0B, false, false));
+    TEST_ASSERT_EQUAL(1, strobe_count);
+    TEST_ASSERT_EQUAL(0x0B, last_output.key_code);
+
+    run_until(virtual_now + AY3600_RESUME_CONFIRM_MS);
+    TEST_ASSERT_TRUE(last_output.any_key);
+}
+
+// Test: Store saves alternate slots and restore picks the newest
+void test_snapshot_store_alternates(void)
+{
+    ay3600_snapshot_store_t store;
+
+    memset(&store, 0xA5, sizeof(store));
+    init_emulator(0, 500);
+    TEST_ASSERT_EQUAL(-1, ay3600_snapshot_store_save(NULL));
+    TEST_ASSERT_EQUAL(-1, ay3600_snapshot_store_restore(&store));
+
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_store_save(&store));
+    TEST_ASSERT_EQUAL(0, store.slots[0].sequence);
+    ay3600_press_key(0x11, false, false);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_store_save(&store));
+    TEST_ASSERT_EQUAL(1, store.slots[1].sequence);
+    TEST_ASSERT_EQUAL(0x11, store.slots[1].key_code);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_store_save(&store));
+    TEST_ASSERT_EQUAL(2, store.slots[0].sequence);
+
+    init_emulator(0, 500);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_store_restore(&store));
+    TEST_ASSERT_EQUAL(0x11, last_output.key_code);
+    TEST_ASSERT_TRUE(last_output.any_key);
+}
+
+// Test: A save torn by a reset leaves the previous snapshot usable
+void test_snapshot_store_torn_save(void)
+{
+    ay3600_snapshot_store_t store;
+
+    memset(&store, 0, sizeof(store));
+    init_emulator(0, 500);
+    ay3600_press_key(0x12, false, false);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_store_save(&store));
+    ay3600_release_key();
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_store_save(&store));
+
+    // Reset hit while the next save was writing slot 0
+    memset(&store.slots[0], 0, sizeof(store.slots[0]) / 2);
+
+    init_emulator(0, 500);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_store_restore(&store));
+    TEST_ASSERT_FALSE(last_output.any_key);
+
+    // The next save overwrites the torn slot, not the good one
+    ay3600_press_key(0x13, false, false);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_store_save(&store));
+    TEST_ASSERT_EQUAL(0x13, store.slots[0].key_code);
+    TEST_ASSERT_EQUAL(2, store.slots[0].sequence);
+}
+
+static void reseal(ay3600_snapshot_t *snapshot, uint16_t sequence)
+{
+    snapshot->sequence = sequence;
+    snapshot->crc = crc32_compute(snapshot, offsetof(ay3600_snapshot_t, crc));
+}
+
+// Test: Sequence comparison survives wrap-around
+void test_snapshot_store_sequence_wrap(void)
+{
+    ay3600_snapshot_store_t store;
+
+    init_emulator(0, 500);
+    ay3600_press_key(0x14, false, false);
+    ay3600_snapshot_save(&store.slots[0]);
+    reseal(&store.slots[0], 0xFFFF);
+    ay3600_press_key(0x15, false, false);
+    ay3600_snapshot_save(&store.slots[1]);
+    reseal(&store.slots[1], 0x0000);
+
+    init_emulator(0, 500);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_store_restore(&store));
+    TEST_ASSERT_EQUAL(0x15, last_output.key_code);
+
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_store_save(&store));
+    TEST_ASSERT_EQUAL(1, store.slots[0].sequence);
+    TEST_ASSERT_EQUAL(0x0000, store.slots[1].sequence);
+}
+
+// Test: Snapshot file round trip for the native build
+void test_snapshot_file(void)
+{
+    char path[] = "/tmp/ay3600_snapshot_XXXXXX";
+    int fd = mkstemp(path);
+
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    init_emulator(0, 500);
+    ay3600_press_key(0x1B, false, false);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_save_file(path));
+
+    init_emulator(0, 500);
+    TEST_ASSERT_EQUAL(0, ay3600_snapshot_restore_file(path));
+    TEST_ASSERT_EQUAL(0x1B, last_output.key_code);
+    TEST_ASSERT_TRUE(last_output.any_key);
+
+    // Truncated file
+    FILE *file = fopen(path, "wb");
+    fputs("AY36", file);
+    fclose(file);
+    TEST_ASSERT_EQUAL(-1, ay3600_snapshot_restore_file(path));
+
+    unlink(path);
+    TEST_ASSERT_EQUAL(-1, ay3600_snapshot_restore_file(path));
+}
+
+// Test: Save and restore take microseconds
+void test_snapshot_speed(void)
+{
+    ay3600_snapshot_t snapshot;
+    struct timespec start, end;
+    const int iterations = 100000;
+
+    init_emulator(0, 500);
+    ay3600_press_key(0x04, false, false);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        ay3600_snapshot_save(&snapshot);
+        ay3600_snapshot_restore(&snapshot);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / iterations;
+    char msg[64];
+    snprintf(msg, sizeof(msg), "snapshot: %.0f ns per save + restore", ns);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(ns < 10000.0);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    // Save / restore tests
+    RUN_TEST(test_snapshot_save_header);
+    RUN_TEST(test_snapshot_held_key);
+    RUN_TEST(test_snapshot_rebases_deadline);
+    RUN_TEST(test_snapshot_during_debounce);
+    RUN_TEST(test_snapshot_restores_settings);
+    RUN_TEST(test_snapshot_rejects_invalid);
+    RUN_TEST(test_snapshot_resyncs_loop_monitor);
+
+    // Resume confirmation tests
+    RUN_TEST(test_snapshot_unconfirmed_key_released);
+    RUN_TEST(test_snapshot_confirmed_key_repeats);
+    RUN_TEST(test_snapshot_other_key_ends_wait);
+
+    // Double-buffered store tests
+    RUN_TEST(test_snapshot_store_alternates);
+    RUN_TEST(test_snapshot_store_torn_save);
+    RUN_TEST(test_snapshot_store_sequence_wrap);
+
+    // Persistence tests
+    RUN_TEST(test_snapshot_file);
+    RUN_TEST(test_snapshot_speed);
+
+    return UNITY_END();
+}
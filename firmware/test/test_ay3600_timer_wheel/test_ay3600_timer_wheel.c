@@ -0,0 +1,317 @@
+/**
+ * @file test_ay3600_timer_wheel.c
+ * @brief Unit tests for the hierarchical timer wheel
+ */
+
+#include "unity.h"
+#include "ay3600_emulator.h"
+#include "ay3600_timer_wheel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_FIRES 4096
+
+// Test fixture data
+static ay3600_timer_wheel_t wheel;
+static uint8_t fired_id[MAX_FIRES];
+static uint32_t fired_at[MAX_FIRES];
+static int fire_count;
+static uint32_t reschedule_period;
+static ay3600_output_t last_output;
+
+static void record_callback(uint8_t id, void *arg)
+{
+    ay3600_timer_wheel_t *w = arg;
+    if (fire_count < MAX_FIRES) {
+        fired_id[fire_count] = id;
+        fired_at[fire_count] = w->now;
+    }
+    fire_count++;
+
+    if (reschedule_period) {
+        ay3600_timer_wheel_schedule(w, id, w->now + reschedule_period);
+    }
+}
+
+static void output_callback(const ay3600_output_t *output)
+{
+    last_output = *output;
+}
+
+static void sleep_ms(unsigned ms)
+{
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+void setUp(void)
+{
+    fire_count = 0;
+    reschedule_period = 0;
+    memset(&last_output, 0, sizeof(last_output));
+    ay3600_timer_wheel_init(&wheel, 1000, record_callback, &wheel);
+}
+
+void tearDown(void)
+{
+}
+
+void test_timer_wheel_fires_at_deadline(void)
+{
+    TEST_ASSERT_EQUAL(0, ay3600_timer_wheel_schedule(&wheel, 3, 1010));
+    TEST_ASSERT_TRUE(ay3600_timer_wheel_active(&wheel, 3));
+
+    TEST_ASSERT_EQUAL(0, ay3600_timer_wheel_advance(&wheel, 1009));
+    TEST_ASSERT_EQUAL(1, ay3600_timer_wheel_advance(&wheel, 1010));
+    TEST_ASSERT_EQUAL(3, fired_id[0]);
+    TEST_ASSERT_EQUAL(1010, fired_at[0]);
+    TEST_ASSERT_FALSE(ay3600_timer_wheel_active(&wheel, 3));
+}
+
+void test_timer_wheel_fires_in_deadline_order(void)
+{
+    ay3600_timer_wheel_schedule(&wheel, 0, 1000 + 70000);
+    ay3600_timer_wheel_schedule(&wheel, 1, 1000 + 500);
+    ay3600_timer_wheel_schedule(&wheel, 2, 1000 + 20);
+    ay3600_timer_wheel_schedule(&wheel, 3, 1000 + 5000);
+    ay3600_timer_wheel_schedule(&wheel, 4, 1000 + 20);
+
+    TEST_ASSERT_EQUAL(5, ay3600_timer_wheel_advance(&wheel, 1000 + 100000));
+    TEST_ASSERT_EQUAL(2, fired_id[0]);
+    TEST_ASSERT_EQUAL(4, fired_id[1]);  // Same millisecond: insertion order
+    TEST_ASSERT_EQUAL(1, fired_id[2]);
+    TEST_ASSERT_EQUAL(3, fired_id[3]);
+    TEST_ASSERT_EQUAL(0, fired_id[4]);
+    TEST_ASSERT_EQUAL(1000 + 500, fired_at[2]);
+    TEST_ASSERT_EQUAL(1000 + 5000, fired_at[3]);
+    TEST_ASSERT_EQUAL(1000 + 70000, fired_at[4]);
+}
+
+void test_timer_wheel_cancel(void)
+{
+    ay3600_timer_wheel_schedule(&wheel, 1, 1005);
+    ay3600_timer_wheel_schedule(&wheel, 2, 1005);
+    ay3600_timer_wheel_schedule(&wheel, 3, 1005);
+
+    TEST_ASSERT_EQUAL(0, ay3600_timer_wheel_cancel(&wheel, 2));
+    TEST_ASSERT_EQUAL(0, ay3600_timer_wheel_cancel(&wheel, 2));
+    TEST_ASSERT_EQUAL(2, ay3600_timer_wheel_advance(&wheel, 2000));
+    TEST_ASSERT_EQUAL(1, fired_id[0]);
+    TEST_ASSERT_EQUAL(3, fired_id[1]);
+}
+
+void test_timer_wheel_reschedule_moves_timer(void)
+{
+    ay3600_timer_wheel_schedule(&wheel, 5, 1010);
+    ay3600_timer_wheel_schedule(&wheel, 5, 1300);
+
+    TEST_ASSERT_EQUAL(0, ay3600_timer_wheel_advance(&wheel, 1299));
+    TEST_ASSERT_EQUAL(1, ay3600_timer_wheel_advance(&wheel, 1300));
+}
+
+void test_timer_wheel_next_deadline(void)
+{
+    uint32_t deadline;
+
+    TEST_ASSERT_FALSE(ay3600_timer_wheel_next_deadline(&wheel, &deadline));
+
+    ay3600_timer_wheel_schedule(&wheel, 0, 1000 + 9000);
+    TEST_ASSERT_TRUE(ay3600_timer_wheel_next_deadline(&wheel, &deadline));
+    TEST_ASSERT_EQUAL(1000 + 9000, deadline);
+
+    ay3600_timer_wheel_schedule(&wheel, 1, 1000 + 130);
+    ay3600_timer_wheel_schedule(&wheel, 2, 1000 + 150);
+    ay3600_timer_wheel_next_deadline(&wheel, &deadline);
+    TEST_ASSERT_EQUAL(1000 + 130, deadline);
+
+    ay3600_timer_wheel_schedule(&wheel, 3, 1000 + 7);
+    ay3600_timer_wheel_next_deadline(&wheel, &deadline);
+    TEST_ASSERT_EQUAL(1000 + 7, deadline);
+}
+
+void test_timer_wheel_past_deadline_fires_next_tick(void)
+{
+    ay3600_timer_wheel_schedule(&wheel, 0, 900);
+
+    uint32_t deadline;
+    ay3600_timer_wheel_next_deadline(&wheel, &deadline);
+    TEST_ASSERT_EQUAL(1001, deadline);
+    TEST_ASSERT_EQUAL(0, ay3600_timer_wheel_advance(&wheel, 1000));
+    TEST_ASSERT_EQUAL(1, ay3600_timer_wheel_advance(&wheel, 1001));
+}
+
+void test_timer_wheel_long_delay_is_clamped(void)
+{
+    ay3600_timer_wheel_schedule(&wheel, 0, 1000 + 10000000);
+
+    uint32_t deadline;
+    ay3600_timer_wheel_next_deadline(&wheel, &deadline);
+    TEST_ASSERT_EQUAL(1000 + AY3600_TIMER_WHEEL_MAX_DELAY, deadline);
+}
+
+void test_timer_wheel_clock_wraparound(void)
+{
+    ay3600_timer_wheel_init(&wheel, 0xFFFFFF00, record_callback, &wheel);
+    ay3600_timer_wheel_schedule(&wheel, 0, 0x00000100);
+    ay3600_timer_wheel_schedule(&wheel, 1, 0xFFFFFFF0);
+
+    TEST_ASSERT_EQUAL(2, ay3600_timer_wheel_advance(&wheel, 0x00000200));
+    TEST_ASSERT_EQUAL(1, fired_id[0]);
+    TEST_ASSERT_EQUAL(0, fired_id[1]);
+    TEST_ASSERT_EQUAL(0x00000100, fired_at[1]);
+}
+
+void test_timer_wheel_periodic_catches_up(void)
+{
+    reschedule_period = 1;
+    ay3600_timer_wheel_schedule(&wheel, 0, 1001);
+
+    // Rescheduled relative to the firing tick, so a jump catches up
+    TEST_ASSERT_EQUAL(10, ay3600_timer_wheel_advance(&wheel, 1010));
+    TEST_ASSERT_EQUAL(1, ay3600_timer_wheel_advance(&wheel, 1011));
+}
+
+void test_timer_wheel_invalid_id(void)
+{
+    TEST_ASSERT_EQUAL(-1, ay3600_timer_wheel_schedule(&wheel, AY3600_TIMER_WHEEL_CAPACITY, 1001));
+    TEST_ASSERT_EQUAL(-1, ay3600_timer_wheel_cancel(&wheel, AY3600_TIMER_WHEEL_CAPACITY));
+    TEST_ASSERT_FALSE(ay3600_timer_wheel_active(&wheel, AY3600_TIMER_WHEEL_CAPACITY));
+}
+
+// Compare against a brute-force model under random operations
+void test_timer_wheel_matches_model(void)
+{
+    uint32_t model[AY3600_TIMER_WHEEL_CAPACITY];
+    bool armed[AY3600_TIMER_WHEEL_CAPACITY] = { false };
+    uint32_t now = 1000;
+
+    srand(12345);
+    for (int step = 0; step < 20000; step++) {
+        int op = rand() % 4;
+        uint8_t id = rand() % AY3600_TIMER_WHEEL_CAPACITY;
+
+        if (op == 0) {
+            uint32_t delay = (rand() % 3 == 0) ? rand() % 100000 : 1 + rand() % 200;
+            ay3600_timer_wheel_schedule(&wheel, id, now + delay);
+            model[id] = delay ? now + delay : now + 1;
+            armed[id] = true;
+        } else if (op == 1) {
+            ay3600_timer_wheel_cancel(&wheel, id);
+            armed[id] = false;
+        } else {
+            uint32_t to = now + rand() % 300;
+            fire_count = 0;
+            ay3600_timer_wheel_advance(&wheel, to);
+
+            // Every fired timer was due, in non-decreasing deadline order
+            for (int i = 0; i < fire_count; i++) {
+                TEST_ASSERT_TRUE(armed[fired_id[i]]);
+                TEST_ASSERT_EQUAL(model[fired_id[i]], fired_at[i]);
+                if (i > 0) {
+                    TEST_ASSERT_TRUE(fired_at[i] >= fired_at[i - 1]);
+                }
+                armed[fired_id[i]] = false;
+            }
+            // Nothing due was left behind
+            for (int i = 0; i < AY3600_TIMER_WHEEL_CAPACITY; i++) {
+                TEST_ASSERT_EQUAL(armed[i], ay3600_timer_wheel_active(&wheel, i));
+                if (armed[i]) {
+                    TEST_ASSERT_TRUE((int32_t)(model[i] - to) > 0);
+                }
+            }
+            now = to;
+        }
+
+        uint32_t expected = 0, actual = 0;
+        bool any = false;
+        for (int i = 0; i < AY3600_TIMER_WHEEL_CAPACITY; i++) {
+            if (armed[i] && (!any || (int32_t)(model[i] - expected) < 0)) {
+                expected = model[i];
+                any = true;
+            }
+        }
+        TEST_ASSERT_EQUAL(any, ay3600_timer_wheel_next_deadline(&wheel, &actual));
+        if (any) {
+            TEST_ASSERT_EQUAL(expected, actual);
+        }
+    }
+}
+
+// Emulator integration
+void test_emulator_next_deadline_tracks_debounce(void)
+{
+    ay3600_config_t config = {
+        .output_callback = output_callback,
+        .debounce_ms = 20,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    ay3600_init(&config);
+
+    uint32_t deadline;
+    TEST_ASSERT_EQUAL(-1, ay3600_next_deadline(&deadline));
+
+    ay3600_press_key(0x04, false, false);
+    TEST_ASSERT_EQUAL(0, ay3600_next_deadline(&deadline));
+    TEST_ASSERT_FALSE(last_output.any_key);
+
+    sleep_ms(25);
+    ay3600_process();
+    TEST_ASSERT_TRUE(last_output.any_key);
+    TEST_ASSERT_EQUAL(0x04, last_output.key_code);
+
+    // Now waiting for the repeat delay
+    uint32_t repeat_deadline;
+    TEST_ASSERT_EQUAL(0, ay3600_next_deadline(&repeat_deadline));
+    TEST_ASSERT_TRUE((int32_t)(repeat_deadline - deadline) >= 500);
+
+    ay3600_release_key();
+    TEST_ASSERT_EQUAL(-1, ay3600_next_deadline(&deadline));
+}
+
+void test_emulator_release_during_debounce(void)
+{
+    ay3600_config_t config = {
+        .output_callback = output_callback,
+        .debounce_ms = 5,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    ay3600_init(&config);
+
+    ay3600_press_key(0x04, false, false);
+    ay3600_release_key();
+    sleep_ms(10);
+    ay3600_process();
+
+    ay3600_stats_t stats;
+    ay3600_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.total_keypresses);
+    TEST_ASSERT_FALSE(last_output.any_key);
+}
+
+// Main test runner
+int main(void)
+{
+    UNITY_BEGIN();
+
+    // Wheel tests
+    RUN_TEST(test_timer_wheel_fires_at_deadline);
+    RUN_TEST(test_timer_wheel_fires_in_deadline_order);
+    RUN_TEST(test_timer_wheel_cancel);
+    RUN_TEST(test_timer_wheel_reschedule_moves_timer);
+    RUN_TEST(test_timer_wheel_next_deadline);
+    RUN_TEST(test_timer_wheel_past_deadline_fires_next_tick);
+    RUN_TEST(test_timer_wheel_long_delay_is_clamped);
+    RUN_TEST(test_timer_wheel_clock_wraparound);
+    RUN_TEST(test_timer_wheel_periodic_catches_up);
+    RUN_TEST(test_timer_wheel_invalid_id);
+    RUN_TEST(test_timer_wheel_matches_model);
+
+    // Emulator integration tests
+    RUN_TEST(test_emulator_next_deadline_tracks_debounce);
+    RUN_TEST(test_emulator_release_during_debounce);
+
+    return UNITY_END();
+}
@@ -0,0 +1,293 @@
+/**
+ * @file test_ay3600_timing.c
+ * @brief Unit tests for the output driver and timing conformance checker
+ */
+
+#include "unity.h"
+#include "ay3600_emulator.h"
+#include "ay3600_output.h"
+#include "ay3600_timing.h"
+#include <string.h>
+#include <time.h>
+
+#define TRACE_LEN 256
+#define WRITE_COST_NS 50
+
+// Test fixture data
+static ay3600_transition_t transitions[TRACE_LEN];
+static ay3600_trace_t trace;
+static ay3600_output_driver_t driver;
+static ay3600_timing_report_t report;
+
+static void drive_callback(const ay3600_output_t *output)
+{
+    ay3600_output_drive(&driver, output);
+    ay3600_trace_advance(&trace, 1000000);  // 1 ms between updates
+}
+
+static uint64_t real_clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void init_emulator(void)
+{
+    ay3600_config_t config = {
+        .output_callback = drive_callback,
+        .debounce_ms = 0,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    ay3600_init(&config);
+}
+
+// Append a transition to a hand-built waveform
+static void add(uint64_t time_ns, ay3600_pin_t pin, int level)
+{
+    transitions[trace.count].time_ns = time_ns;
+    transitions[trace.count].pin = pin;
+    transitions[trace.count].level = level;
+    trace.count++;
+}
+
+void setUp(void)
+{
+    memset(&report, 0, sizeof(report));
+    ay3600_trace_init(&trace, transitions, TRACE_LEN, WRITE_COST_NS);
+
+    ay3600_output_hal_t hal;
+    ay3600_trace_hal(&trace, &hal);
+    ay3600_output_driver_init(&driver, &hal, AY3600_STROBE_WIDTH_US);
+    init_emulator();
+}
+
+void tearDown(void)
+{
+    ay3600_reset();
+}
+
+// Driver tests
+void test_output_driver_init_null(void)
+{
+    ay3600_output_hal_t hal = { 0 };
+    TEST_ASSERT_EQUAL(-1, ay3600_output_driver_init(NULL, &hal, 1));
+    TEST_ASSERT_EQUAL(-1, ay3600_output_driver_init(&driver, &hal, 1));
+}
+
+void test_output_driver_press_sequence(void)
+{
+    // Init wrote every pin low: no transitions
+    TEST_ASSERT_EQUAL(0, trace.count);
+
+    ay3600_press_key(0x05, true, false);  // D0, D2, CONTROL
+
+    TEST_ASSERT_EQUAL(6, trace.count);
+    TEST_ASSERT_EQUAL(AY3600_PIN_D0, transitions[0].pin);
+    TEST_ASSERT_EQUAL(AY3600_PIN_D2, transitions[1].pin);
+    TEST_ASSERT_EQUAL(AY3600_PIN_CONTROL, transitions[2].pin);
+    TEST_ASSERT_EQUAL(AY3600_PIN_ANY_KEY, transitions[3].pin);
+    TEST_ASSERT_EQUAL(AY3600_PIN_KSTRB, transitions[4].pin);
+    TEST_ASSERT_EQUAL(1, transitions[4].level);
+    TEST_ASSERT_EQUAL(AY3600_PIN_KSTRB, transitions[5].pin);
+    TEST_ASSERT_EQUAL(0, transitions[5].level);
+}
+
+void test_output_driver_release_drops_any_key_first(void)
+{
+    ay3600_press_key(0x01, false, true);
+    uint32_t start = trace.count;
+    ay3600_release_key();
+
+    TEST_ASSERT_EQUAL(start + 3, trace.count);
+    TEST_ASSERT_EQUAL(AY3600_PIN_ANY_KEY, transitions[start].pin);
+    TEST_ASSERT_EQUAL(0, transitions[start].level);
+}
+
+void test_output_driver_rollover_writes_changed_pins_only(void)
+{
+    ay3600_press_key(0x03, false, false);
+    uint32_t start = trace.count;
+    ay3600_press_key(0x02, false, false);  // Only D0 changes
+
+    TEST_ASSERT_EQUAL(start + 3, trace.count);
+    TEST_ASSERT_EQUAL(AY3600_PIN_D0, transitions[start].pin);
+    TEST_ASSERT_EQUAL(AY3600_PIN_KSTRB, transitions[start + 1].pin);
+}
+
+// Conformance tests
+void test_timing_emulator_waveform_conforms(void)
+{
+    ay3600_press_key(0x00, false, false);
+    ay3600_release_key();
+    ay3600_press_key(0x1F, true, true);
+    ay3600_press_key(0x0A, false, true);   // Rollover
+    ay3600_release_key();
+    ay3600_press_key(0x0A, false, false);  // Same code again
+    ay3600_reset();
+
+    int violations = ay3600_timing_check(transitions, trace.count, NULL, &report);
+    TEST_ASSERT_EQUAL(0, violations);
+    TEST_ASSERT_EQUAL(4, report.strobes);
+    TEST_ASSERT_EQUAL(0, trace.dropped);
+
+    // Strobe: 1 µs delay plus the rising write
+    TEST_ASSERT_EQUAL(WRITE_COST_NS, report.worst_margin_ns[AY3600_CHECK_STROBE_WIDTH]);
+    // Rollover: only D0 written, then KSTRB
+    TEST_ASSERT_EQUAL(WRITE_COST_NS, report.worst_margin_ns[AY3600_CHECK_DATA_SETUP]);
+    TEST_ASSERT_TRUE(report.checked[AY3600_CHECK_ANY_KEY_ORDER]);
+}
+
+void test_timing_real_clock_waveform_conforms(void)
+{
+    trace.clock_ns = real_clock_ns;
+
+    for (int i = 0; i < 8; i++) {
+        ay3600_press_key(i * 3, i & 1, i & 2);
+        ay3600_release_key();
+    }
+
+    TEST_ASSERT_EQUAL(0, ay3600_timing_check(transitions, trace.count, NULL, &report));
+    TEST_ASSERT_EQUAL(8, report.strobes);
+}
+
+void test_timing_short_strobe(void)
+{
+    add(0, AY3600_PIN_D1, 1);
+    add(100, AY3600_PIN_ANY_KEY, 1);
+    add(200, AY3600_PIN_KSTRB, 1);
+    add(700, AY3600_PIN_KSTRB, 0);
+
+    TEST_ASSERT_EQUAL(1, ay3600_timing_check(transitions, trace.count, NULL, &report));
+    TEST_ASSERT_EQUAL(AY3600_CHECK_STROBE_WIDTH, report.violations[0].check);
+    TEST_ASSERT_EQUAL(3, report.violations[0].transition);
+    TEST_ASSERT_EQUAL(-500, report.violations[0].margin_ns);
+}
+
+void test_timing_long_strobe(void)
+{
+    add(0, AY3600_PIN_ANY_KEY, 1);
+    add(100, AY3600_PIN_KSTRB, 1);
+    add(20100, AY3600_PIN_KSTRB, 0);
+
+    TEST_ASSERT_EQUAL(1, ay3600_timing_check(transitions, trace.count, NULL, &report));
+    TEST_ASSERT_EQUAL(-10000, report.violations[0].margin_ns);
+}
+
+void test_timing_data_changes_during_strobe(void)
+{
+    add(0, AY3600_PIN_ANY_KEY, 1);
+    add(100, AY3600_PIN_KSTRB, 1);
+    add(400, AY3600_PIN_D3, 1);
+    add(1500, AY3600_PIN_KSTRB, 0);
+
+    TEST_ASSERT_EQUAL(1, ay3600_timing_check(transitions, trace.count, NULL, &report));
+    TEST_ASSERT_EQUAL(AY3600_CHECK_DATA_HOLD, report.violations[0].check);
+    TEST_ASSERT_EQUAL(2, report.violations[0].transition);
+    TEST_ASSERT_EQUAL(-1100, report.violations[0].margin_ns);
+}
+
+void test_timing_setup_limit(void)
+{
+    ay3600_timing_limits_t limits = AY3600_TIMING_LIMITS_DEFAULT;
+    limits.data_setup_min_ns = 200;
+
+    add(0, AY3600_PIN_ANY_KEY, 1);
+    add(1000, AY3600_PIN_SHIFT, 1);
+    add(1050, AY3600_PIN_KSTRB, 1);
+    add(2050, AY3600_PIN_KSTRB, 0);
+
+    TEST_ASSERT_EQUAL(1, ay3600_timing_check(transitions, trace.count, &limits, &report));
+    TEST_ASSERT_EQUAL(AY3600_CHECK_DATA_SETUP, report.violations[0].check);
+    TEST_ASSERT_EQUAL(-150, report.violations[0].margin_ns);
+}
+
+void test_timing_strobe_before_any_key(void)
+{
+    add(0, AY3600_PIN_D0, 1);
+    add(100, AY3600_PIN_KSTRB, 1);
+    add(1200, AY3600_PIN_KSTRB, 0);
+    add(1300, AY3600_PIN_ANY_KEY, 1);
+
+    TEST_ASSERT_EQUAL(1, ay3600_timing_check(transitions, trace.count, NULL, &report));
+    TEST_ASSERT_EQUAL(AY3600_CHECK_ANY_KEY_SETUP, report.violations[0].check);
+    TEST_ASSERT_EQUAL(1, report.violations[0].transition);
+    TEST_ASSERT_EQUAL(-1200, report.violations[0].margin_ns);
+}
+
+void test_timing_data_cleared_before_any_key(void)
+{
+    add(0, AY3600_PIN_D4, 1);
+    add(100, AY3600_PIN_ANY_KEY, 1);
+    add(200, AY3600_PIN_KSTRB, 1);
+    add(1300, AY3600_PIN_KSTRB, 0);
+    add(5000, AY3600_PIN_D4, 0);
+    add(5300, AY3600_PIN_ANY_KEY, 0);
+
+    TEST_ASSERT_EQUAL(1, ay3600_timing_check(transitions, trace.count, NULL, &report));
+    TEST_ASSERT_EQUAL(AY3600_CHECK_ANY_KEY_ORDER, report.violations[0].check);
+    TEST_ASSERT_EQUAL(4, report.violations[0].transition);
+    TEST_ASSERT_EQUAL(-300, report.violations[0].margin_ns);
+}
+
+void test_timing_ignores_unknown_pins(void)
+{
+    add(0, AY3600_PIN_ANY_KEY, 1);
+    add(50, AY3600_PIN_COUNT, 1);
+    add(60, 40, 1);
+    add(100, AY3600_PIN_KSTRB, 1);
+    add(1100, AY3600_PIN_KSTRB, 0);
+
+    TEST_ASSERT_EQUAL(0, ay3600_timing_check(transitions, trace.count, NULL, &report));
+    TEST_ASSERT_EQUAL(1, report.strobes);
+}
+
+void test_timing_recorder_overflow(void)
+{
+    ay3600_trace_init(&trace, transitions, 4, WRITE_COST_NS);
+    ay3600_output_hal_t hal;
+    ay3600_trace_hal(&trace, &hal);
+    ay3600_output_driver_init(&driver, &hal, 1);
+
+    ay3600_press_key(0x1F, true, true);
+
+    TEST_ASSERT_EQUAL(4, trace.count);
+    TEST_ASSERT_EQUAL(6, trace.dropped);
+}
+
+void test_timing_check_null(void)
+{
+    TEST_ASSERT_EQUAL(-1, ay3600_timing_check(transitions, 1, NULL, NULL));
+    TEST_ASSERT_EQUAL(-1, ay3600_timing_check(NULL, 1, NULL, &report));
+    TEST_ASSERT_EQUAL_STRING("strobe-width", ay3600_timing_check_name(AY3600_CHECK_STROBE_WIDTH));
+}
+
+// Main test runner
+int main(void)
+{
+    UNITY_BEGIN();
+
+    // Output driver tests
+    RUN_TEST(test_output_driver_init_null);
+    RUN_TEST(test_output_driver_press_sequence);
+    RUN_TEST(test_output_driver_release_drops_any_key_first);
+    RUN_TEST(test_output_driver_rollover_writes_changed_pins_only);
+
+    // Emulator conformance tests
+    RUN_TEST(test_timing_emulator_waveform_conforms);
+    RUN_TEST(test_timing_real_clock_waveform_conforms);
+
+    // Checker tests
+    RUN_TEST(test_timing_short_strobe);
+    RUN_TEST(test_timing_long_strobe);
+    RUN_TEST(test_timing_data_changes_during_strobe);
+    RUN_TEST(test_timing_setup_limit);
+    RUN_TEST(test_timing_strobe_before_any_key);
+    RUN_TEST(test_timing_data_cleared_before_any_key);
+    RUN_TEST(test_timing_ignores_unknown_pins);
+    RUN_TEST(test_timing_recorder_overflow);
+    RUN_TEST(test_timing_check_null);
+
+    return UNITY_END();
+}
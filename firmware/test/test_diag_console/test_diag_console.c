@@ -0,0 +1,325 @@
+/**
+ * @file test_diag_console.c
+ * @brief Unit tests for the diagnostics console
+ */
+
+#include "unity.h"
+#include "ay3600_emulator.h"
+#include "key_injector.h"
+#include "keyboard_layout.h"
+#include "diag_console.h"
+#include <string.h>
+
+// Test fixture data
+static diag_console_t console;
+static char output[8192];
+static size_t output_len;
+
+static void capture_write(void *ctx, const char *text, size_t len)
+{
+    (void)ctx;
+    if (len > sizeof(output) - 1 - output_len) {
+        len = sizeof(output) - 1 - output_len;
+    }
+    memcpy(&output[output_len], text, len);
+    output_len += len;
+    output[output_len] = '\0';
+}
+
+static void clear_output(void)
+{
+    output_len = 0;
+    output[0] = '\0';
+}
+
+static uint32_t virtual_now;
+static int strobe_count;
+
+static uint32_t virtual_clock(void)
+{
+    return virtual_now;
+}
+
+static void count_strobes(const ay3600_output_t *output)
+{
+    if (output->strobe) {
+        strobe_count++;
+    }
+}
+
+static void feed(const char *text)
+{
+    diag_console_feed(&console, text, strlen(text));
+}
+
+void setUp(void)
+{
+    ay3600_config_t config = {
+        .output_callback = NULL,
+        .debounce_ms = 0,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    key_injector_config_t injector_config = {
+        .hold_ms = 20,
+        .gap_ms = 10,
+    };
+    diag_console_config_t console_config = {
+        .write = capture_write,
+    };
+
+    ay3600_init(&config);
+    key_injector_init(&injector_config);
+    keyboard_layout_set(&keyboard_layout_us);
+    clear_output();
+    TEST_ASSERT_EQUAL(0, diag_console_init(&console, &console_config));
+}
+
+void tearDown(void)
+{
+    ay3600_reset();
+}
+
+// Test: Initialization prints the prompt and checks arguments
+void test_console_init(void)
+{
+    diag_console_config_t bad = { .write = NULL };
+
+    TEST_ASSERT_EQUAL_STRING("> ", output);
+    TEST_ASSERT_EQUAL(-1, diag_console_init(&console, NULL));
+    TEST_ASSERT_EQUAL(-1, diag_console_init(&console, &bad));
+}
+
+// Test: help lists every command
+void test_console_help(void)
+{
+    TEST_ASSERT_EQUAL(0, diag_console_execute(&console, "help"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "stats"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "hist"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "set"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "reset"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "layout"));
+}
+
+// Test: stats reports live emulator counters
+void test_console_stats(void)
+{
+    ay3600_press_key(0x01, false, false);
+    ay3600_release_key();
+    ay3600_press_key(0x02, false, false);
+
+    clear_output();
+    TEST_ASSERT_EQUAL(0, diag_console_execute(&console, "stats"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "keypresses=2"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "debounce=0ms delay=500ms rate=50ms"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "overruns=0"));
+}
+
+// Test: hist prints selected histograms with non-empty buckets
+void test_console_hist(void)
+{
+    for (int i = 0; i < 5; i++) {
+        ay3600_process();
+    }
+
+    clear_output();
+    TEST_ASSERT_EQUAL(0, diag_console_execute(&console, "hist interval"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "process interval (us): n=4"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "#"));
+    TEST_ASSERT_NULL(strstr(output, "injector"));
+
+    clear_output();
+    TEST_ASSERT_EQUAL(0, diag_console_execute(&console, "hist"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "process call (us): n=5"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "injector latency (ms): n=0"));
+
+    TEST_ASSERT_EQUAL(-1, diag_console_execute(&console, "hist bogus"));
+}
+
+// Test: set only takes effect when the emulator task applies it
+void test_console_set_deferred(void)
+{
+    ay3600_config_t config;
+
+    TEST_ASSERT_EQUAL(0, diag_console_execute(&console, "set debounce 30"));
+    TEST_ASSERT_EQUAL(0, diag_console_execute(&console, "set rate 40"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "queued: debounce=30ms delay=500ms rate=40ms"));
+
+    ay3600_get_config(&config);
+    TEST_ASSERT_EQUAL(0, config.debounce_ms);
+
+    TEST_ASSERT_TRUE(diag_console_apply(&console));
+    ay3600_get_config(&config);
+    TEST_ASSERT_EQUAL(30, config.debounce_ms);
+    TEST_ASSERT_EQUAL(500, config.repeat_delay_ms);
+    TEST_ASSERT_EQUAL(40, config.repeat_rate_ms);
+
+    TEST_ASSERT_FALSE(diag_console_apply(&console));
+}
+
+// Test: raising debounce also lengthens the injector hold
+void test_console_set_debounce_updates_hold(void)
+{
+    ay3600_config_t config = {
+        .output_callback = count_strobes,
+        .debounce_ms = 20,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+        .clock_ms = virtual_clock,
+    };
+    key_injector_config_t injector_config = {
+        .hold_ms = 20 + KEY_INJECTOR_HOLD_MARGIN_MS,
+        .gap_ms = 10,
+    };
+
+    virtual_now = 1000;
+    strobe_count = 0;
+    ay3600_init(&config);
+    key_injector_init(&injector_config);
+
+    TEST_ASSERT_EQUAL(0, diag_console_execute(&console, "set debounce 60"));
+    TEST_ASSERT_TRUE(diag_console_apply(&console));
+
+    TEST_ASSERT_EQUAL(0, key_injector_push_keystroke(0x05, false, false, virtual_now));
+    for (int i = 0; i < 200; i++) {
+        key_injector_process(virtual_now);
+        ay3600_process();
+        virtual_now++;
+    }
+    TEST_ASSERT_EQUAL(1, strobe_count);
+}
+
+// Test: set rejects bad arguments without queuing anything
+void test_console_set_invalid(void)
+{
+    TEST_ASSERT_EQUAL(-1, diag_console_execute(&console, "set debounce"));
+    TEST_ASSERT_EQUAL(-1, diag_console_execute(&console, "set speed 10"));
+    TEST_ASSERT_EQUAL(-1, diag_console_execute(&console, "set rate 70000"));
+    TEST_ASSERT_EQUAL(-1, diag_console_execute(&console, "set rate 12x"));
+    TEST_ASSERT_FALSE(diag_console_apply(&console));
+}
+
+// Test: reset clears emulator and injector counters on apply
+void test_console_reset(void)
+{
+    ay3600_stats_t stats;
+    key_injector_stats_t injector;
+
+    ay3600_press_key(0x01, false, false);
+    key_injector_push_keystroke(0x02, false, false, 0);
+    ay3600_process();
+
+    TEST_ASSERT_EQUAL(0, diag_console_execute(&console, "reset"));
+    ay3600_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.total_keypresses);
+
+    TEST_ASSERT_TRUE(diag_console_apply(&console));
+    ay3600_get_stats(&stats);
+    key_injector_get_stats(&injector);
+    TEST_ASSERT_EQUAL(0, stats.total_keypresses);
+    TEST_ASSERT_EQUAL(0, stats.max_process_duration_us);
+    TEST_ASSERT_EQUAL(0, injector.events_queued);
+}
+
+// Test: layout shows and switches the active layout
+void test_console_layout(void)
+{
+    TEST_ASSERT_EQUAL(0, diag_console_execute(&console, "layout"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "layout: us"));
+    TEST_ASSERT_NOT_NULL(strstr(output, "dvorak"));
+
+    TEST_ASSERT_EQUAL(0, diag_console_execute(&console, "layout de"));
+    TEST_ASSERT_EQUAL_PTR(&keyboard_layout_de, keyboard_layout_get());
+
+    TEST_ASSERT_EQUAL(-1, diag_console_execute(&console, "layout xx"));
+    TEST_ASSERT_EQUAL_PTR(&keyboard_layout_de, keyboard_layout_get());
+}
+
+// Test: Line input handles CR LF, backspace, blanks and overlong lines
+void test_console_line_editing(void)
+{
+    char longline[DIAG_CONSOLE_LINE_MAX + 8];
+
+    feed("stq\bats\r\n");
+    TEST_ASSERT_NOT_NULL(strstr(output, "keypresses="));
+
+    clear_output();
+    feed("\r\n   \n");
+    TEST_ASSERT_EQUAL_STRING("> > ", output);
+
+    clear_output();
+    feed("bogus\n");
+    TEST_ASSERT_NOT_NULL(strstr(output, "unknown command 'bogus'"));
+
+    memset(longline, 'x', sizeof(longline) - 2);
+    longline[sizeof(longline) - 2] = '\n';
+    longline[sizeof(longline) - 1] = '\0';
+    clear_output();
+    feed(longline);
+    TEST_ASSERT_NOT_NULL(strstr(output, "line too long"));
+
+    clear_output();
+    feed("layout\n");
+    TEST_ASSERT_NOT_NULL(strstr(output, "layout: us"));
+}
+
+// Test: CR LF split across single-byte feeds ends exactly one line
+void test_console_crlf_byte_by_byte(void)
+{
+    const char *line = "help\r\n";
+    size_t len;
+
+    clear_output();
+    for (const char *p = line; *p; p++) {
+        diag_console_feed(&console, p, 1);
+    }
+    TEST_ASSERT_NOT_NULL(strstr(output, "stats"));
+
+    // One prompt after the help text, not a second one for an empty line
+    len = strlen(output);
+    TEST_ASSERT_TRUE(len >= 3);
+    TEST_ASSERT_EQUAL_STRING("\n> ", &output[len - 3]);
+    TEST_ASSERT_NULL(strstr(output, "> > "));
+
+    // A lone LF after a completed line still ends the next one
+    clear_output();
+    feed("\n");
+    TEST_ASSERT_EQUAL_STRING("> ", output);
+}
+
+// Test: Echo mode reflects typed characters for raw serial terminals
+void test_console_echo(void)
+{
+    diag_console_config_t config = {
+        .write = capture_write,
+        .echo = true,
+    };
+
+    TEST_ASSERT_EQUAL(0, diag_console_init(&console, &config));
+    clear_output();
+    feed("hx\x7f");
+    TEST_ASSERT_EQUAL_STRING("hx\b \b", output);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    // Command tests
+    RUN_TEST(test_console_init);
+    RUN_TEST(test_console_help);
+    RUN_TEST(test_console_stats);
+    RUN_TEST(test_console_hist);
+    RUN_TEST(test_console_set_deferred);
+    RUN_TEST(test_console_set_debounce_updates_hold);
+    RUN_TEST(test_console_set_invalid);
+    RUN_TEST(test_console_reset);
+    RUN_TEST(test_console_layout);
+
+    // Line input tests
+    RUN_TEST(test_console_line_editing);
+    RUN_TEST(test_console_crlf_byte_by_byte);
+    RUN_TEST(test_console_echo);
+
+    return UNITY_END();
+}
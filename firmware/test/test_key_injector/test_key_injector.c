@@ -0,0 +1,251 @@
+/**
+ * @file test_key_injector.c
+ * @brief Unit tests for paced key injection
+ */
+
+#include "unity.h"
+#include "ay3600_emulator.h"
+#include "key_injector.h"
+#include <string.h>
+
+// Test fixture data
+static ay3600_output_t outputs[64];
+static int callback_count;
+
+// Test callback
+static void test_callback(const ay3600_output_t *output)
+{
+    if (callback_count < 64) {
+        outputs[callback_count] = *output;
+    }
+    callback_count++;
+}
+
+static uint32_t virtual_now;
+
+static uint32_t virtual_clock(void)
+{
+    return virtual_now;
+}
+
+static int count_strobes(void)
+{
+    int strobes = 0;
+    for (int i = 0; i < callback_count && i < 64; i++) {
+        if (outputs[i].strobe) {
+            strobes++;
+        }
+    }
+    return strobes;
+}
+
+static void init_emulator(void)
+{
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = 0,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    ay3600_init(&config);
+}
+
+static void init_injector(uint16_t hold_ms, uint16_t gap_ms)
+{
+    key_injector_config_t config = {
+        .hold_ms = hold_ms,
+        .gap_ms = gap_ms,
+    };
+    key_injector_init(&config);
+}
+
+void setUp(void)
+{
+    memset(outputs, 0, sizeof(outputs));
+    callback_count = 0;
+    init_emulator();
+}
+
+void tearDown(void)
+{
+    ay3600_reset();
+}
+
+void test_key_injector_init_null_config(void)
+{
+    TEST_ASSERT_EQUAL(-1, key_injector_init(NULL));
+}
+
+void test_key_injector_keystroke_is_held(void)
+{
+    init_injector(30, 10);
+
+    TEST_ASSERT_EQUAL(0, key_injector_push_keystroke(0x07, false, true, 1000));
+
+    // Press applies immediately
+    TEST_ASSERT_EQUAL(1, key_injector_process(1000));
+    TEST_ASSERT_EQUAL(1, callback_count);
+    TEST_ASSERT_EQUAL(0x07, outputs[0].key_code);
+    TEST_ASSERT_TRUE(outputs[0].shift);
+    TEST_ASSERT_TRUE(outputs[0].any_key);
+
+    // Release waits for hold_ms
+    TEST_ASSERT_EQUAL(0, key_injector_process(1029));
+    TEST_ASSERT_TRUE(key_injector_pending());
+    TEST_ASSERT_EQUAL(1, key_injector_process(1030));
+    TEST_ASSERT_EQUAL(2, callback_count);
+    TEST_ASSERT_FALSE(outputs[1].any_key);
+    TEST_ASSERT_FALSE(key_injector_pending());
+}
+
+void test_key_injector_gap_between_keystrokes(void)
+{
+    init_injector(5, 20);
+
+    key_injector_push_keystroke(0x01, false, false, 0);
+    key_injector_push_keystroke(0x02, false, false, 0);
+
+    TEST_ASSERT_EQUAL(1, key_injector_process(0));   // press 1
+    TEST_ASSERT_EQUAL(1, key_injector_process(5));   // release 1
+    TEST_ASSERT_EQUAL(0, key_injector_process(24));  // gap not yet elapsed
+    TEST_ASSERT_EQUAL(1, key_injector_process(25));  // press 2
+    TEST_ASSERT_EQUAL(0x02, outputs[2].key_code);
+}
+
+void test_key_injector_release_waits_for_hold(void)
+{
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = 20,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+        .clock_ms = virtual_clock,
+    };
+    ay3600_key_event_t event = { .key_code = 0x05, .pressed = true };
+
+    virtual_now = 1000;
+    ay3600_init(&config);
+    init_injector(40, 10);
+
+    // Separate press and release, as binary network frames arrive
+    TEST_ASSERT_EQUAL(0, key_injector_push(&event, virtual_now));
+    event.pressed = false;
+    TEST_ASSERT_EQUAL(0, key_injector_push(&event, virtual_now));
+
+    for (int i = 0; i < 100; i++) {
+        key_injector_process(virtual_now);
+        ay3600_process();
+        virtual_now++;
+    }
+
+    TEST_ASSERT_EQUAL(1, count_strobes());
+    TEST_ASSERT_FALSE(outputs[callback_count - 1].any_key);
+}
+
+void test_key_injector_release_of_other_key_uses_gap(void)
+{
+    init_injector(40, 10);
+
+    ay3600_key_event_t event = { .key_code = 0x01, .pressed = true };
+    key_injector_push(&event, 0);
+    event.key_code = 0x02;
+    event.pressed = false;
+    key_injector_push(&event, 0);
+
+    TEST_ASSERT_EQUAL(1, key_injector_process(0));
+    TEST_ASSERT_EQUAL(1, key_injector_process(10));
+}
+
+void test_key_injector_unpaced_batch(void)
+{
+    init_injector(0, 0);
+
+    for (int i = 0; i < 8; i++) {
+        key_injector_push_keystroke(i, false, false, 0);
+    }
+
+    TEST_ASSERT_EQUAL(16, key_injector_process(0));
+    TEST_ASSERT_EQUAL(16, callback_count);
+    TEST_ASSERT_EQUAL(0x07, outputs[14].key_code);
+}
+
+void test_key_injector_queue_full(void)
+{
+    init_injector(0, 0);
+
+    ay3600_key_event_t event = { .key_code = 0x01, .pressed = true };
+    for (int i = 0; i < KEY_INJECTOR_QUEUE_LEN; i++) {
+        TEST_ASSERT_EQUAL(0, key_injector_push(&event, 0));
+    }
+    TEST_ASSERT_EQUAL(0, key_injector_space());
+    TEST_ASSERT_EQUAL(-1, key_injector_push(&event, 0));
+
+    key_injector_stats_t stats;
+    key_injector_get_stats(&stats);
+    TEST_ASSERT_EQUAL(KEY_INJECTOR_QUEUE_LEN, stats.events_queued);
+    TEST_ASSERT_EQUAL(1, stats.events_rejected);
+    TEST_ASSERT_EQUAL(KEY_INJECTOR_QUEUE_LEN, stats.max_depth);
+}
+
+void test_key_injector_keystroke_needs_two_slots(void)
+{
+    init_injector(0, 0);
+
+    ay3600_key_event_t event = { .key_code = 0x01, .pressed = true };
+    for (int i = 0; i < KEY_INJECTOR_QUEUE_LEN - 1; i++) {
+        key_injector_push(&event, 0);
+    }
+    TEST_ASSERT_EQUAL(-1, key_injector_push_keystroke(0x02, false, false, 0));
+    TEST_ASSERT_EQUAL(1, key_injector_space());
+}
+
+void test_key_injector_invalid_key_code(void)
+{
+    init_injector(0, 0);
+    TEST_ASSERT_EQUAL(-1, key_injector_push_keystroke(32, false, false, 0));
+    TEST_ASSERT_EQUAL(-1, key_injector_push(NULL, 0));
+}
+
+void test_key_injector_latency_histogram(void)
+{
+    init_injector(0, 0);
+
+    key_injector_push_keystroke(0x01, false, false, 100);
+    key_injector_process(104);
+
+    key_injector_stats_t stats;
+    key_injector_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.events_applied);
+    TEST_ASSERT_EQUAL(2, stats.latency_ms.count);
+    TEST_ASSERT_EQUAL(4, stats.latency_ms.max);
+    TEST_ASSERT_EQUAL(2, stats.latency_ms.buckets[3]);
+
+    key_injector_reset_stats();
+    key_injector_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.latency_ms.count);
+}
+
+// Main test runner
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_key_injector_init_null_config);
+
+    // Pacing tests
+    RUN_TEST(test_key_injector_keystroke_is_held);
+    RUN_TEST(test_key_injector_gap_between_keystrokes);
+    RUN_TEST(test_key_injector_release_waits_for_hold);
+    RUN_TEST(test_key_injector_release_of_other_key_uses_gap);
+    RUN_TEST(test_key_injector_unpaced_batch);
+
+    // Bounded queue tests
+    RUN_TEST(test_key_injector_queue_full);
+    RUN_TEST(test_key_injector_keystroke_needs_two_slots);
+    RUN_TEST(test_key_injector_invalid_key_code);
+
+    // Statistics tests
+    RUN_TEST(test_key_injector_latency_histogram);
+
+    return UNITY_END();
+}
@@ -0,0 +1,261 @@
+/**
+ * @file test_keyboard_layout.c
+ * @brief Unit tests for keyboard layouts
+ */
+
+#include "unity.h"
+#include "ay3600_emulator.h"
+#include "keyboard_layout.h"
+#include <string.h>
+
+#define HID(letter) (HID_USAGE_A + ((letter) - 'A'))
+#define CODE(letter) (AY3600_KEY_A + ((letter) - 'A'))
+
+// Test fixture data
+static ay3600_output_t last_output;
+static keyboard_layout_t user_layout;
+
+// Test callback
+static void test_callback(const ay3600_output_t *output)
+{
+    last_output = *output;
+}
+
+void setUp(void)
+{
+    memset(&last_output, 0, sizeof(last_output));
+    keyboard_layout_set(&keyboard_layout_us);
+
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = 0,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    ay3600_init(&config);
+    keyboard_layout_clear_held();
+}
+
+void tearDown(void)
+{
+    ay3600_reset();
+    keyboard_layout_set(&keyboard_layout_us);
+}
+
+void test_keyboard_layout_default_is_us(void)
+{
+    TEST_ASSERT_TRUE(keyboard_layout_get() == &keyboard_layout_us);
+}
+
+void test_keyboard_layout_us_letters(void)
+{
+    for (char c = 'A'; c <= 'Z'; c++) {
+        TEST_ASSERT_EQUAL_HEX8(KEYBOARD_LAYOUT_ENTRY(CODE(c)), keyboard_layout_lookup(HID(c)));
+    }
+    TEST_ASSERT_EQUAL_HEX8(KEYBOARD_LAYOUT_ENTRY(AY3600_KEY_RETURN),
+                           keyboard_layout_lookup(HID_USAGE_ENTER));
+    TEST_ASSERT_EQUAL_HEX8(0, keyboard_layout_lookup(0x00));
+    TEST_ASSERT_EQUAL_HEX8(0, keyboard_layout_lookup(0xFF));
+}
+
+void test_keyboard_layout_every_builtin_maps_all_letters(void)
+{
+    const keyboard_layout_t *layout;
+    unsigned count = 0;
+
+    for (unsigned i = 0; (layout = keyboard_layout_builtin(i)) != NULL; i++) {
+        count++;
+        uint32_t seen = 0;
+        for (unsigned usage = 0; usage < KEYBOARD_LAYOUT_SIZE; usage++) {
+            uint8_t entry = layout->map[usage];
+            if ((entry & KEYBOARD_LAYOUT_VALID) &&
+                (entry & KEYBOARD_LAYOUT_CODE_MASK) <= AY3600_KEY_Z) {
+                TEST_ASSERT_FALSE(seen & (1UL << (entry & KEYBOARD_LAYOUT_CODE_MASK)));
+                seen |= 1UL << (entry & KEYBOARD_LAYOUT_CODE_MASK);
+            }
+        }
+        TEST_ASSERT_EQUAL_HEX32(0x03FFFFFF, seen);
+    }
+    TEST_ASSERT_EQUAL(4, count);
+}
+
+void test_keyboard_layout_dvorak(void)
+{
+    keyboard_layout_set(&keyboard_layout_dvorak);
+    ay3600_key_event_t event;
+
+    TEST_ASSERT_EQUAL(0, keyboard_layout_translate(HID('S'), false, false, true, &event));
+    TEST_ASSERT_EQUAL(CODE('O'), event.key_code);
+    TEST_ASSERT_EQUAL(0, keyboard_layout_translate(HID_USAGE_SEMICOLON, false, false, true, &event));
+    TEST_ASSERT_EQUAL(CODE('S'), event.key_code);
+    TEST_ASSERT_EQUAL(-1, keyboard_layout_translate(HID('Q'), false, false, true, &event));
+}
+
+void test_keyboard_layout_international(void)
+{
+    ay3600_key_event_t event;
+
+    keyboard_layout_set(keyboard_layout_find("fr"));
+    keyboard_layout_translate(HID('Q'), false, false, true, &event);
+    TEST_ASSERT_EQUAL(CODE('A'), event.key_code);
+    keyboard_layout_translate(HID_USAGE_SEMICOLON, false, false, true, &event);
+    TEST_ASSERT_EQUAL(CODE('M'), event.key_code);
+
+    keyboard_layout_set(keyboard_layout_find("de"));
+    keyboard_layout_translate(HID('Y'), false, false, true, &event);
+    TEST_ASSERT_EQUAL(CODE('Z'), event.key_code);
+}
+
+void test_keyboard_layout_find(void)
+{
+    TEST_ASSERT_TRUE(keyboard_layout_find("dvorak") == &keyboard_layout_dvorak);
+    TEST_ASSERT_NULL(keyboard_layout_find("klingon"));
+    TEST_ASSERT_NULL(keyboard_layout_find(NULL));
+    TEST_ASSERT_EQUAL(-1, keyboard_layout_set(NULL));
+}
+
+void test_keyboard_layout_translate_modifiers(void)
+{
+    ay3600_key_event_t event;
+
+    TEST_ASSERT_EQUAL(0, keyboard_layout_translate(HID('C'), true, true, false, &event));
+    TEST_ASSERT_EQUAL(CODE('C'), event.key_code);
+    TEST_ASSERT_TRUE(event.control);
+    TEST_ASSERT_TRUE(event.shift);
+    TEST_ASSERT_FALSE(event.pressed);
+    TEST_ASSERT_EQUAL(-1, keyboard_layout_translate(HID('C'), false, false, true, NULL));
+}
+
+void test_keyboard_layout_user_remap(void)
+{
+    TEST_ASSERT_EQUAL(0, keyboard_layout_copy(&user_layout, &keyboard_layout_us, "user"));
+
+    // Caps Lock (0x39) sends Ctrl-C
+    TEST_ASSERT_EQUAL(0, keyboard_layout_remap(&user_layout, 0x39,
+                      KEYBOARD_LAYOUT_ENTRY(CODE('C')) | KEYBOARD_LAYOUT_CONTROL));
+    TEST_ASSERT_EQUAL(0, keyboard_layout_set(&user_layout));
+
+    ay3600_key_event_t event;
+    TEST_ASSERT_EQUAL(0, keyboard_layout_translate(0x39, false, false, true, &event));
+    TEST_ASSERT_EQUAL(CODE('C'), event.key_code);
+    TEST_ASSERT_TRUE(event.control);
+    TEST_ASSERT_EQUAL_STRING("user", keyboard_layout_get()->name);
+
+    // The active table cannot be edited in place
+    TEST_ASSERT_EQUAL(-1, keyboard_layout_remap(&user_layout, 0x39, 0));
+    TEST_ASSERT_EQUAL(-1, keyboard_layout_copy(&user_layout, &keyboard_layout_de, NULL));
+}
+
+void test_keyboard_layout_switch_while_key_held(void)
+{
+    ay3600_key_event_t event;
+
+    keyboard_layout_translate(HID('Y'), false, false, true, &event);
+    ay3600_handle_event(&event);
+    TEST_ASSERT_EQUAL(CODE('Y'), last_output.key_code);
+
+    keyboard_layout_set(&keyboard_layout_de);
+    TEST_ASSERT_EQUAL(0, keyboard_layout_translate(HID('Y'), false, false, false, &event));
+    TEST_ASSERT_EQUAL(CODE('Y'), event.key_code);
+    ay3600_handle_event(&event);
+    TEST_ASSERT_FALSE(last_output.any_key);
+
+    keyboard_layout_translate(HID('Y'), false, false, true, &event);
+    ay3600_handle_event(&event);
+    TEST_ASSERT_EQUAL(CODE('Z'), last_output.key_code);
+    TEST_ASSERT_TRUE(last_output.any_key);
+}
+
+void test_keyboard_layout_release_after_switch(void)
+{
+    ay3600_key_event_t event;
+    ay3600_stats_t stats;
+
+    // HID 'Y' is Z under QWERTZ
+    keyboard_layout_set(&keyboard_layout_de);
+    keyboard_layout_translate(HID('Y'), false, false, true, &event);
+    ay3600_handle_event(&event);
+    TEST_ASSERT_EQUAL(CODE('Z'), last_output.key_code);
+
+    // Switch back and let go: the release still names Z
+    keyboard_layout_set(&keyboard_layout_us);
+    TEST_ASSERT_EQUAL(0, keyboard_layout_translate(HID('Y'), false, false, false, &event));
+    TEST_ASSERT_EQUAL(CODE('Z'), event.key_code);
+    ay3600_handle_event(&event);
+    TEST_ASSERT_FALSE(last_output.any_key);
+
+    // Nothing left to repeat
+    TEST_ASSERT_EQUAL(-1, ay3600_next_deadline(&(uint32_t){0}));
+    ay3600_process();
+    ay3600_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.total_repeats);
+}
+
+// Releases match presses through the translator, including under rollover
+void test_keyboard_layout_rollover_release_contract(void)
+{
+    ay3600_key_event_t event;
+
+    keyboard_layout_translate(HID('A'), false, false, true, &event);
+    ay3600_handle_event(&event);
+
+    // HID 'Z' is Y under QWERTZ and rolls over A
+    keyboard_layout_set(&keyboard_layout_de);
+    keyboard_layout_translate(HID('Z'), false, false, true, &event);
+    ay3600_handle_event(&event);
+    TEST_ASSERT_EQUAL(CODE('Y'), last_output.key_code);
+
+    // Releasing the rolled-over key leaves the newer one down
+    keyboard_layout_translate(HID('A'), false, false, false, &event);
+    TEST_ASSERT_EQUAL(CODE('A'), event.key_code);
+    ay3600_handle_event(&event);
+    TEST_ASSERT_TRUE(last_output.any_key);
+
+    // After switching back, HID 'Z' still releases Y, not Z
+    keyboard_layout_set(&keyboard_layout_us);
+    keyboard_layout_translate(HID('Z'), false, false, false, &event);
+    TEST_ASSERT_EQUAL(CODE('Y'), event.key_code);
+    ay3600_handle_event(&event);
+    TEST_ASSERT_FALSE(last_output.any_key);
+    TEST_ASSERT_EQUAL(-1, ay3600_next_deadline(&(uint32_t){0}));
+}
+
+void test_keyboard_layout_clear_held(void)
+{
+    ay3600_key_event_t event;
+
+    keyboard_layout_set(&keyboard_layout_de);
+    keyboard_layout_translate(HID('Y'), false, false, true, &event);
+    keyboard_layout_clear_held();
+
+    // Without a recorded press the active layout is used
+    keyboard_layout_set(&keyboard_layout_us);
+    TEST_ASSERT_EQUAL(0, keyboard_layout_translate(HID('Y'), false, false, false, &event));
+    TEST_ASSERT_EQUAL(CODE('Y'), event.key_code);
+}
+
+// Main test runner
+int main(void)
+{
+    UNITY_BEGIN();
+
+    // Built-in layout tests
+    RUN_TEST(test_keyboard_layout_default_is_us);
+    RUN_TEST(test_keyboard_layout_us_letters);
+    RUN_TEST(test_keyboard_layout_every_builtin_maps_all_letters);
+    RUN_TEST(test_keyboard_layout_dvorak);
+    RUN_TEST(test_keyboard_layout_international);
+    RUN_TEST(test_keyboard_layout_find);
+
+    // Translation tests
+    RUN_TEST(test_keyboard_layout_translate_modifiers);
+
+    // Remap and switching tests
+    RUN_TEST(test_keyboard_layout_user_remap);
+    RUN_TEST(test_keyboard_layout_switch_while_key_held);
+    RUN_TEST(test_keyboard_layout_release_after_switch);
+    RUN_TEST(test_keyboard_layout_rollover_release_contract);
+    RUN_TEST(test_keyboard_layout_clear_held);
+
+    return UNITY_END();
+}
@@ -0,0 +1,309 @@
+/**
+ * @file test_matrix_debounce.c
+ * @brief Unit tests for adaptive per-key matrix debounce
+ */
+
+#include "unity.h"
+#include "matrix_debounce.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SCAN_US 250
+
+// Test fixture data
+static matrix_debounce_t md;
+static uint32_t now_us;
+static int reports;
+static bool last_pressed;
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(0, matrix_debounce_init(&md, NULL));
+    now_us = 0;
+    reports = 0;
+    last_pressed = false;
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Scan one key at the given raw level for a span of time
+ */
+static void hold(uint8_t key, bool raw, uint32_t duration_us)
+{
+    uint32_t end = now_us + duration_us;
+
+    do {
+        bool pressed;
+        if (matrix_debounce_update(&md, key, raw, now_us, &pressed) == 1) {
+            reports++;
+            last_pressed = pressed;
+        }
+        now_us += SCAN_US;
+    } while ((int32_t)(end - now_us) > 0);
+}
+
+/**
+ * @brief Press with a bounce burst of the given length, then settle
+ */
+static void bouncy_press(uint8_t key, uint32_t bounce_us)
+{
+    for (uint32_t t = 0; t < bounce_us; t += 2 * SCAN_US) {
+        hold(key, true, SCAN_US);
+        hold(key, false, SCAN_US);
+    }
+    hold(key, true, 25000);
+}
+
+static void bouncy_release(uint8_t key, uint32_t bounce_us)
+{
+    for (uint32_t t = 0; t < bounce_us; t += 2 * SCAN_US) {
+        hold(key, false, SCAN_US);
+        hold(key, true, SCAN_US);
+    }
+    hold(key, false, 25000);
+}
+
+// =============================================================================
+// Debounce tests
+// =============================================================================
+
+void test_debounce_init(void)
+{
+    matrix_debounce_config_t bad = MATRIX_DEBOUNCE_CONFIG_DEFAULT;
+
+    TEST_ASSERT_EQUAL(20000, matrix_debounce_lockout_us(&md, 0));
+    TEST_ASSERT_EQUAL(20000, matrix_debounce_lockout_us(&md, MATRIX_DEBOUNCE_KEYS - 1));
+
+    bad.min_lockout_us = 30000;
+    TEST_ASSERT_EQUAL(-1, matrix_debounce_init(&md, &bad));
+    bad = (matrix_debounce_config_t)MATRIX_DEBOUNCE_CONFIG_DEFAULT;
+    bad.min_samples = MATRIX_DEBOUNCE_HISTORY + 1;
+    TEST_ASSERT_EQUAL(-1, matrix_debounce_init(&md, &bad));
+    TEST_ASSERT_EQUAL(-1, matrix_debounce_init(NULL, NULL));
+}
+
+void test_debounce_coalesces_bounces(void)
+{
+    matrix_debounce_stats_t stats;
+
+    bouncy_press(3, 3000);
+    TEST_ASSERT_EQUAL(1, reports);
+    TEST_ASSERT_TRUE(last_pressed);
+
+    bouncy_release(3, 3000);
+    TEST_ASSERT_EQUAL(2, reports);
+    TEST_ASSERT_FALSE(last_pressed);
+
+    matrix_debounce_get_stats(&md, &stats);
+    TEST_ASSERT_EQUAL(2, stats.reports);
+    TEST_ASSERT_TRUE(stats.edges > 10);
+}
+
+void test_debounce_reports_after_lockout(void)
+{
+    uint32_t start = now_us;
+
+    hold(5, true, 19000);
+    TEST_ASSERT_EQUAL(0, reports);
+    hold(5, true, 2000);
+    TEST_ASSERT_EQUAL(1, reports);
+    TEST_ASSERT_TRUE(now_us - start >= 20000);
+}
+
+void test_debounce_learns_lockout(void)
+{
+    for (int i = 0; i < 4; i++) {
+        bouncy_press(7, 2000);
+        bouncy_release(7, 2000);
+    }
+    TEST_ASSERT_EQUAL(8, reports);
+
+    // Bursts are 2 ms from first to last edge, so 1.5 x p95 is 3 ms
+    TEST_ASSERT_EQUAL(3000, matrix_debounce_lockout_us(&md, 7));
+
+    // Other keys are untouched
+    TEST_ASSERT_EQUAL(20000, matrix_debounce_lockout_us(&md, 8));
+}
+
+void test_debounce_clean_switch_hits_minimum(void)
+{
+    for (int i = 0; i < 4; i++) {
+        hold(9, true, 25000);
+        hold(9, false, 25000);
+    }
+    TEST_ASSERT_EQUAL(8, reports);
+    TEST_ASSERT_EQUAL(1000, matrix_debounce_lockout_us(&md, 9));
+}
+
+void test_debounce_worn_switch_clamped(void)
+{
+    for (int i = 0; i < 4; i++) {
+        bouncy_press(11, 16000);
+        bouncy_release(11, 16000);
+    }
+    TEST_ASSERT_EQUAL(8, reports);
+    TEST_ASSERT_EQUAL(20000, matrix_debounce_lockout_us(&md, 11));
+}
+
+void test_debounce_rejects_glitch(void)
+{
+    matrix_debounce_stats_t stats;
+
+    hold(2, true, SCAN_US);
+    hold(2, false, 25000);
+    TEST_ASSERT_EQUAL(0, reports);
+
+    matrix_debounce_get_stats(&md, &stats);
+    TEST_ASSERT_EQUAL(1, stats.glitches);
+}
+
+void test_debounce_detects_chatter(void)
+{
+    matrix_debounce_stats_t stats;
+    uint32_t learned;
+
+    for (int i = 0; i < 4; i++) {
+        hold(4, true, 25000);
+        hold(4, false, 25000);
+    }
+    TEST_ASSERT_EQUAL(1000, matrix_debounce_lockout_us(&md, 4));
+
+    // Bounce longer than the learned lockout
+    hold(4, true, 1500);
+    hold(4, false, SCAN_US);
+    hold(4, true, 25000);
+
+    matrix_debounce_get_stats(&md, &stats);
+    TEST_ASSERT_EQUAL(1, stats.chatter);
+    TEST_ASSERT_EQUAL(9, reports);
+    TEST_ASSERT_TRUE(last_pressed);
+
+    // The extended burst raises the lockout
+    learned = matrix_debounce_lockout_us(&md, 4);
+    TEST_ASSERT_TRUE(learned > 1000);
+}
+
+void test_debounce_timestamp_wrap(void)
+{
+    now_us = UINT32_MAX - 5000;
+    bouncy_press(1, 2000);
+    TEST_ASSERT_EQUAL(1, reports);
+    TEST_ASSERT_TRUE(now_us < 100000);
+    bouncy_release(1, 2000);
+    TEST_ASSERT_EQUAL(2, reports);
+}
+
+void test_debounce_invalid_key(void)
+{
+    bool pressed;
+
+    TEST_ASSERT_EQUAL(-1, matrix_debounce_update(&md, MATRIX_DEBOUNCE_KEYS, true, 0, &pressed));
+    TEST_ASSERT_EQUAL(0, matrix_debounce_lockout_us(&md, MATRIX_DEBOUNCE_KEYS));
+}
+
+// =============================================================================
+// Persistence tests
+// =============================================================================
+
+void test_debounce_export_import(void)
+{
+    static uint8_t blob[MATRIX_DEBOUNCE_BLOB_SIZE];
+    static matrix_debounce_t restored;
+
+    for (int i = 0; i < 5; i++) {
+        bouncy_press(7, 2000);
+        bouncy_release(7, 2000);
+        hold(9, true, 25000);
+        hold(9, false, 25000);
+    }
+    TEST_ASSERT_EQUAL(0, matrix_debounce_export(&md, blob, sizeof(blob) - 1));
+    TEST_ASSERT_EQUAL(MATRIX_DEBOUNCE_BLOB_SIZE, matrix_debounce_export(&md, blob, sizeof(blob)));
+
+    TEST_ASSERT_EQUAL(0, matrix_debounce_init(&restored, NULL));
+    TEST_ASSERT_EQUAL(0, matrix_debounce_import(&restored, blob, sizeof(blob)));
+    TEST_ASSERT_EQUAL(matrix_debounce_lockout_us(&md, 7), matrix_debounce_lockout_us(&restored, 7));
+    TEST_ASSERT_EQUAL(1000, matrix_debounce_lockout_us(&restored, 9));
+    TEST_ASSERT_EQUAL(20000, matrix_debounce_lockout_us(&restored, 0));
+
+    // Round trip is byte-identical after the ring has wrapped
+    {
+        static uint8_t again[MATRIX_DEBOUNCE_BLOB_SIZE];
+        matrix_debounce_export(&restored, again, sizeof(again));
+        TEST_ASSERT_EQUAL(0, memcmp(blob, again, sizeof(blob)));
+    }
+}
+
+void test_debounce_import_rejects_invalid(void)
+{
+    static uint8_t blob[MATRIX_DEBOUNCE_BLOB_SIZE];
+
+    for (int i = 0; i < 4; i++) {
+        hold(9, true, 25000);
+        hold(9, false, 25000);
+    }
+    matrix_debounce_export(&md, blob, sizeof(blob));
+    TEST_ASSERT_EQUAL(0, matrix_debounce_init(&md, NULL));
+
+    TEST_ASSERT_EQUAL(-1, matrix_debounce_import(&md, blob, sizeof(blob) - 1));
+    blob[20] ^= 0x01;
+    TEST_ASSERT_EQUAL(-1, matrix_debounce_import(&md, blob, sizeof(blob)));
+    blob[20] ^= 0x01;
+    blob[4] = MATRIX_DEBOUNCE_VERSION + 1;
+    TEST_ASSERT_EQUAL(-1, matrix_debounce_import(&md, blob, sizeof(blob)));
+    TEST_ASSERT_EQUAL(20000, matrix_debounce_lockout_us(&md, 9));
+
+    blob[4] = MATRIX_DEBOUNCE_VERSION;
+    TEST_ASSERT_EQUAL(0, matrix_debounce_import(&md, blob, sizeof(blob)));
+    TEST_ASSERT_EQUAL(1000, matrix_debounce_lockout_us(&md, 9));
+}
+
+void test_debounce_file(void)
+{
+    static matrix_debounce_t restored;
+    char path[] = "/tmp/matrix_debounce_XXXXXX";
+    int fd = mkstemp(path);
+
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    for (int i = 0; i < 4; i++) {
+        hold(9, true, 25000);
+        hold(9, false, 25000);
+    }
+    TEST_ASSERT_EQUAL(0, matrix_debounce_save_file(&md, path));
+    TEST_ASSERT_EQUAL(0, matrix_debounce_init(&restored, NULL));
+    TEST_ASSERT_EQUAL(0, matrix_debounce_load_file(&restored, path));
+    TEST_ASSERT_EQUAL(1000, matrix_debounce_lockout_us(&restored, 9));
+
+    unlink(path);
+    TEST_ASSERT_EQUAL(-1, matrix_debounce_load_file(&restored, path));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    // Debounce tests
+    RUN_TEST(test_debounce_init);
+    RUN_TEST(test_debounce_coalesces_bounces);
+    RUN_TEST(test_debounce_reports_after_lockout);
+    RUN_TEST(test_debounce_learns_lockout);
+    RUN_TEST(test_debounce_clean_switch_hits_minimum);
+    RUN_TEST(test_debounce_worn_switch_clamped);
+    RUN_TEST(test_debounce_rejects_glitch);
+    RUN_TEST(test_debounce_detects_chatter);
+    RUN_TEST(test_debounce_timestamp_wrap);
+    RUN_TEST(test_debounce_invalid_key);
+
+    // Persistence tests
+    RUN_TEST(test_debounce_export_import);
+    RUN_TEST(test_debounce_import_rejects_invalid);
+    RUN_TEST(test_debounce_file);
+
+    return UNITY_END();
+}
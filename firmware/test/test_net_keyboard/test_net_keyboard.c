@@ -0,0 +1,361 @@
+/**
+ * @file test_net_keyboard.c
+ * @brief Loopback tests for the TCP keyboard server
+ */
+
+#include "unity.h"
+#include "ay3600_emulator.h"
+#include "key_injector.h"
+#include "net_keyboard.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define MAX_STROBES 4096
+
+// Test fixture data
+static ay3600_output_t strobes[MAX_STROBES];
+static uint64_t strobe_time_us[MAX_STROBES];
+static int strobe_count;
+static int release_count;
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(now_us() / 1000);
+}
+
+// Test callback
+static void test_callback(const ay3600_output_t *output)
+{
+    if (output->strobe) {
+        if (strobe_count < MAX_STROBES) {
+            strobes[strobe_count] = *output;
+            strobe_time_us[strobe_count] = now_us();
+        }
+        strobe_count++;
+    } else if (!output->any_key) {
+        release_count++;
+    }
+}
+
+static void pump(void)
+{
+    uint32_t now = now_ms();
+    net_keyboard_poll(now);
+    key_injector_process(now);
+    ay3600_process();
+}
+
+static int pump_until_strobes(int count, uint32_t timeout_ms)
+{
+    uint32_t start = now_ms();
+    while (strobe_count < count && (now_ms() - start) < timeout_ms) {
+        pump();
+    }
+    return strobe_count;
+}
+
+static int connect_client(void)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(net_keyboard_port()),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    TEST_ASSERT_EQUAL(0, connect(fd, (struct sockaddr *)&addr, sizeof(addr)));
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    // Let the server accept before data is sent
+    for (int i = 0; i < 100; i++) {
+        pump();
+    }
+    return fd;
+}
+
+static void send_all(int fd, const void *data, size_t len)
+{
+    TEST_ASSERT_EQUAL((ssize_t)len, send(fd, data, len, 0));
+}
+
+void setUp(void)
+{
+    strobe_count = 0;
+    release_count = 0;
+
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = 0,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    ay3600_init(&config);
+
+    key_injector_config_t injector = {
+        .hold_ms = 0,
+        .gap_ms = 0,
+    };
+    key_injector_init(&injector);
+
+    net_keyboard_config_t server = {
+        .port = 0,
+        .bind_addr = INADDR_LOOPBACK,
+    };
+    TEST_ASSERT_EQUAL(0, net_keyboard_start(&server));
+}
+
+void tearDown(void)
+{
+    net_keyboard_stop();
+    ay3600_reset();
+}
+
+void test_net_keyboard_start_null_config(void)
+{
+    TEST_ASSERT_EQUAL(-1, net_keyboard_start(NULL));
+    TEST_ASSERT_NOT_EQUAL(0, net_keyboard_port());
+}
+
+void test_net_keyboard_text(void)
+{
+    int fd = connect_client();
+    send_all(fd, "Hi\r\n", 4);
+
+    TEST_ASSERT_EQUAL(3, pump_until_strobes(3, 1000));
+    TEST_ASSERT_EQUAL(AY3600_KEY_A + 7, strobes[0].key_code);
+    TEST_ASSERT_TRUE(strobes[0].shift);
+    TEST_ASSERT_EQUAL(AY3600_KEY_A + 8, strobes[1].key_code);
+    TEST_ASSERT_FALSE(strobes[1].shift);
+    TEST_ASSERT_EQUAL(AY3600_KEY_RETURN, strobes[2].key_code);
+    TEST_ASSERT_EQUAL(3, release_count);
+
+    close(fd);
+}
+
+void test_net_keyboard_control_characters(void)
+{
+    int fd = connect_client();
+    send_all(fd, "\x03\x1b~", 3);
+
+    TEST_ASSERT_EQUAL(2, pump_until_strobes(2, 1000));
+    TEST_ASSERT_EQUAL(AY3600_KEY_A + 2, strobes[0].key_code);
+    TEST_ASSERT_TRUE(strobes[0].control);
+    TEST_ASSERT_EQUAL(AY3600_KEY_ESC, strobes[1].key_code);
+    TEST_ASSERT_FALSE(strobes[1].control);
+
+    net_keyboard_stats_t stats;
+    net_keyboard_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.bytes_dropped);
+
+    close(fd);
+}
+
+void test_net_keyboard_binary_events(void)
+{
+    int fd = connect_client();
+    const uint8_t frames[] = {
+        NET_KEYBOARD_FRAME_MARKER,
+        0x05 | NET_KEYBOARD_EVENT_CONTROL | NET_KEYBOARD_EVENT_PRESSED,
+        NET_KEYBOARD_FRAME_MARKER,
+        0x05,
+    };
+    send_all(fd, frames, sizeof(frames));
+
+    TEST_ASSERT_EQUAL(1, pump_until_strobes(1, 1000));
+    for (int i = 0; i < 100 && release_count == 0; i++) {
+        pump();
+    }
+    TEST_ASSERT_EQUAL(0x05, strobes[0].key_code);
+    TEST_ASSERT_TRUE(strobes[0].control);
+    TEST_ASSERT_EQUAL(1, release_count);
+
+    close(fd);
+}
+
+void test_net_keyboard_binary_events_paced(void)
+{
+    // Production pacing: debounce 20 ms, hold debounce + 20, gap 10
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = 20,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    key_injector_config_t injector = {
+        .hold_ms = 40,
+        .gap_ms = 10,
+    };
+    ay3600_init(&config);
+    key_injector_init(&injector);
+
+    int fd = connect_client();
+    const uint8_t frames[] = {
+        NET_KEYBOARD_FRAME_MARKER,
+        0x05 | NET_KEYBOARD_EVENT_PRESSED,
+        NET_KEYBOARD_FRAME_MARKER,
+        0x05,
+    };
+    send_all(fd, frames, sizeof(frames));
+
+    TEST_ASSERT_EQUAL(1, pump_until_strobes(1, 1000));
+    uint32_t start = now_ms();
+    while (release_count == 0 && (now_ms() - start) < 1000) {
+        pump();
+    }
+    TEST_ASSERT_EQUAL(0x05, strobes[0].key_code);
+    TEST_ASSERT_EQUAL(1, release_count);
+    TEST_ASSERT_EQUAL(1, strobe_count);
+
+    close(fd);
+}
+
+void test_net_keyboard_stalled_client_does_not_block(void)
+{
+    int slow = connect_client();
+    int fast = connect_client();
+
+    // Half a binary frame, then nothing
+    const uint8_t partial = NET_KEYBOARD_FRAME_MARKER;
+    send_all(slow, &partial, 1);
+    send_all(fast, "abc", 3);
+
+    TEST_ASSERT_EQUAL(3, pump_until_strobes(3, 1000));
+    TEST_ASSERT_EQUAL(AY3600_KEY_A + 2, strobes[2].key_code);
+
+    close(slow);
+    close(fast);
+}
+
+void test_net_keyboard_backpressure_loses_nothing(void)
+{
+    int fd = connect_client();
+    char text[1024];
+    for (size_t i = 0; i < sizeof(text); i++) {
+        text[i] = 'a' + (i % 26);
+    }
+    send_all(fd, text, sizeof(text));
+
+    // Fill the queue without draining it
+    for (int i = 0; i < 100; i++) {
+        net_keyboard_poll(now_ms());
+    }
+    TEST_ASSERT_TRUE(key_injector_space() < 2);
+
+    TEST_ASSERT_EQUAL((int)sizeof(text), pump_until_strobes(sizeof(text), 5000));
+    for (int i = 0; i < (int)sizeof(text); i++) {
+        TEST_ASSERT_EQUAL(AY3600_KEY_A + (i % 26), strobes[i].key_code);
+    }
+
+    net_keyboard_stats_t stats;
+    net_keyboard_get_stats(&stats);
+    TEST_ASSERT_GREATER_THAN(0, stats.backpressure);
+    TEST_ASSERT_EQUAL(0, stats.bytes_dropped);
+
+    close(fd);
+}
+
+void test_net_keyboard_throughput(void)
+{
+    enum { EVENTS = 4000 };
+    static uint8_t frames[EVENTS * 2];
+    for (int i = 0; i < EVENTS; i++) {
+        frames[i * 2] = NET_KEYBOARD_FRAME_MARKER;
+        frames[i * 2 + 1] = ((i / 2) & 0x1F) | ((i & 1) ? 0 : NET_KEYBOARD_EVENT_PRESSED);
+    }
+
+    int fd = connect_client();
+    uint64_t start = now_us();
+    send_all(fd, frames, sizeof(frames));
+    pump_until_strobes(EVENTS / 2, 10000);
+    while (release_count < EVENTS / 2 && (now_us() - start) < 10000000) {
+        pump();
+    }
+    uint64_t elapsed = now_us() - start;
+
+    TEST_ASSERT_EQUAL(EVENTS / 2, strobe_count);
+    TEST_ASSERT_EQUAL(EVENTS / 2, release_count);
+
+    uint64_t rate = (uint64_t)EVENTS * 1000000 / (elapsed ? elapsed : 1);
+    char msg[96];
+    snprintf(msg, sizeof(msg), "net_keyboard: %d events in %lu us (%lu events/s)",
+             EVENTS, (unsigned long)elapsed, (unsigned long)rate);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_GREATER_THAN(10000, rate);
+
+    close(fd);
+}
+
+void test_net_keyboard_socket_to_strobe_latency(void)
+{
+    enum { SAMPLES = 200 };
+    static uint32_t latency_us[SAMPLES];
+    int fd = connect_client();
+
+    for (int i = 0; i < SAMPLES; i++) {
+        char c = 'a' + (i % 26);
+        int expected = strobe_count + 1;
+        uint64_t sent = now_us();
+        send_all(fd, &c, 1);
+        TEST_ASSERT_EQUAL(expected, pump_until_strobes(expected, 1000));
+        latency_us[i] = (uint32_t)(strobe_time_us[expected - 1] - sent);
+    }
+
+    // Insertion sort for percentiles
+    for (int i = 1; i < SAMPLES; i++) {
+        uint32_t v = latency_us[i];
+        int j = i - 1;
+        while (j >= 0 && latency_us[j] > v) {
+            latency_us[j + 1] = latency_us[j];
+            j--;
+        }
+        latency_us[j + 1] = v;
+    }
+
+    char msg[128];
+    snprintf(msg, sizeof(msg),
+             "net_keyboard: socket-to-strobe latency p50=%u us p99=%u us max=%u us",
+             (unsigned)latency_us[SAMPLES / 2], (unsigned)latency_us[SAMPLES * 99 / 100],
+             (unsigned)latency_us[SAMPLES - 1]);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_LESS_THAN(5000, latency_us[SAMPLES / 2]);
+
+    close(fd);
+}
+
+// Main test runner
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_net_keyboard_start_null_config);
+
+    // Protocol tests
+    RUN_TEST(test_net_keyboard_text);
+    RUN_TEST(test_net_keyboard_control_characters);
+    RUN_TEST(test_net_keyboard_binary_events);
+    RUN_TEST(test_net_keyboard_binary_events_paced);
+
+    // Flow control tests
+    RUN_TEST(test_net_keyboard_stalled_client_does_not_block);
+    RUN_TEST(test_net_keyboard_backpressure_loses_nothing);
+
+    // Performance tests
+    RUN_TEST(test_net_keyboard_throughput);
+    RUN_TEST(test_net_keyboard_socket_to_strobe_latency);
+
+    return UNITY_END();
+}
@@ -0,0 +1,410 @@
+/**
+ * @file test_signal_monitor.c
+ * @brief Unit tests for output sinks and the signal monitor stream
+ */
+
+#include "unity.h"
+#include "ay3600_emulator.h"
+#include "ay3600_output.h"
+#include "signal_monitor.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define MAX_CAPTURE 8192
+#define MAX_EVENTS  1024
+
+// Test fixture data
+static uint16_t sink_changed[64];
+static int sink_calls;
+static int other_calls;
+static int callback_count;
+static uint64_t fake_us;
+static uint8_t captured[MAX_CAPTURE];
+static size_t captured_len;
+static size_t write_limit;
+static signal_monitor_t monitor;
+static signal_monitor_event_t events[MAX_EVENTS];
+static int event_count;
+
+static void test_callback(const ay3600_output_t *output)
+{
+    (void)output;
+    callback_count++;
+}
+
+static void record_sink(const ay3600_output_t *output, uint16_t changed, void *ctx)
+{
+    (void)output;
+    (void)ctx;
+    if (sink_calls < 64) {
+        sink_changed[sink_calls] = changed;
+    }
+    sink_calls++;
+}
+
+static void other_sink(const ay3600_output_t *output, uint16_t changed, void *ctx)
+{
+    (void)output;
+    (void)changed;
+    (*(int *)ctx)++;
+}
+
+static uint64_t fake_clock(void)
+{
+    return fake_us;
+}
+
+static int capture_write(void *ctx, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    if (len > write_limit) {
+        len = write_limit;
+    }
+    if (len > MAX_CAPTURE - captured_len) {
+        len = MAX_CAPTURE - captured_len;
+    }
+    memcpy(&captured[captured_len], data, len);
+    captured_len += len;
+    return (int)len;
+}
+
+static void decode_captured(size_t start)
+{
+    signal_monitor_decoder_t decoder;
+    signal_monitor_decoder_init(&decoder);
+    event_count = 0;
+
+    for (size_t i = start; i < captured_len; i++) {
+        signal_monitor_event_t event;
+        if (signal_monitor_decode(&decoder, captured[i], &event) && event_count < MAX_EVENTS) {
+            events[event_count++] = event;
+        }
+    }
+}
+
+static void init_emulator(void)
+{
+    ay3600_config_t config = {
+        .output_callback = test_callback,
+        .debounce_ms = 0,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    TEST_ASSERT_EQUAL(0, ay3600_init(&config));
+}
+
+static void init_monitor(void)
+{
+    signal_monitor_config_t config = {
+        .write = capture_write,
+        .clock_us = fake_clock,
+    };
+    TEST_ASSERT_EQUAL(0, signal_monitor_init(&monitor, &config));
+}
+
+void setUp(void)
+{
+    sink_calls = 0;
+    other_calls = 0;
+    callback_count = 0;
+    fake_us = 1000;
+    captured_len = 0;
+    write_limit = SIZE_MAX;
+    event_count = 0;
+    init_emulator();
+}
+
+void tearDown(void)
+{
+    ay3600_reset();
+}
+
+// Test: Sinks receive changed-pin masks after the legacy callback
+void test_sink_changed_mask(void)
+{
+    TEST_ASSERT_EQUAL(0, ay3600_add_sink(record_sink, AY3600_PINS_ALL, NULL));
+
+    ay3600_press_key(0x05, true, false);
+    TEST_ASSERT_EQUAL(1, callback_count);
+    TEST_ASSERT_EQUAL(1, sink_calls);
+    TEST_ASSERT_EQUAL_HEX16(0x05 | AY3600_PIN_BIT(AY3600_PIN_CONTROL) |
+                            AY3600_PIN_BIT(AY3600_PIN_ANY_KEY) |
+                            AY3600_PIN_BIT(AY3600_PIN_KSTRB), sink_changed[0]);
+
+    ay3600_release_key();
+    TEST_ASSERT_EQUAL(2, sink_calls);
+    TEST_ASSERT_EQUAL_HEX16(0x05 | AY3600_PIN_BIT(AY3600_PIN_CONTROL) |
+                            AY3600_PIN_BIT(AY3600_PIN_ANY_KEY), sink_changed[1]);
+}
+
+// Test: Pin mask filters updates a sink does not care about
+void test_sink_pin_mask_filter(void)
+{
+    TEST_ASSERT_EQUAL(0, ay3600_add_sink(record_sink, AY3600_PIN_BIT(AY3600_PIN_SHIFT), NULL));
+
+    ay3600_press_key(0x01, false, false);
+    ay3600_release_key();
+    TEST_ASSERT_EQUAL(0, sink_calls);
+
+    ay3600_press_key(0x01, false, true);
+    TEST_ASSERT_EQUAL(1, sink_calls);
+}
+
+// Test: Updates with no pin change (repeated release) skip sinks
+void test_sink_no_change_skipped(void)
+{
+    TEST_ASSERT_EQUAL(0, ay3600_add_sink(record_sink, AY3600_PINS_ALL, NULL));
+
+    ay3600_reset();
+    TEST_ASSERT_EQUAL(0, sink_calls);
+    TEST_ASSERT_EQUAL(1, callback_count);
+}
+
+// Test: Registry capacity and removal
+void test_sink_registry(void)
+{
+    int counters[AY3600_MAX_SINKS] = {0};
+
+    TEST_ASSERT_EQUAL(-1, ay3600_add_sink(NULL, AY3600_PINS_ALL, NULL));
+    for (int i = 0; i < AY3600_MAX_SINKS; i++) {
+        TEST_ASSERT_EQUAL(0, ay3600_add_sink(other_sink, AY3600_PINS_ALL, &counters[i]));
+    }
+    TEST_ASSERT_EQUAL(-1, ay3600_add_sink(record_sink, AY3600_PINS_ALL, NULL));
+
+    TEST_ASSERT_EQUAL(0, ay3600_remove_sink(other_sink, &counters[1]));
+    TEST_ASSERT_EQUAL(-1, ay3600_remove_sink(other_sink, &counters[1]));
+
+    ay3600_press_key(0x02, false, false);
+    TEST_ASSERT_EQUAL(1, counters[0]);
+    TEST_ASSERT_EQUAL(0, counters[1]);
+    TEST_ASSERT_EQUAL(1, counters[2]);
+    TEST_ASSERT_EQUAL(1, counters[3]);
+
+    // init clears the registry
+    init_emulator();
+    ay3600_press_key(0x02, false, false);
+    TEST_ASSERT_EQUAL(1, counters[0]);
+}
+
+// Test: Emulator transitions round-trip through the encoder and decoder
+void test_signal_monitor_round_trip(void)
+{
+    init_monitor();
+    TEST_ASSERT_EQUAL(0, ay3600_add_sink(signal_monitor_sink, AY3600_PINS_ALL, &monitor));
+
+    fake_us = 1500;
+    ay3600_press_key(0x07, false, true);
+    fake_us = 101500;
+    ay3600_release_key();
+    fake_us = 101700;
+    ay3600_press_key(0x07, true, false);
+
+    TEST_ASSERT_EQUAL((int)signal_monitor_pending(&monitor), signal_monitor_flush(&monitor));
+    TEST_ASSERT_EQUAL(0, signal_monitor_pending(&monitor));
+
+    decode_captured(0);
+    TEST_ASSERT_EQUAL(3, event_count);
+
+    TEST_ASSERT_EQUAL(0x07, events[0].output.key_code);
+    TEST_ASSERT_TRUE(events[0].output.shift);
+    TEST_ASSERT_TRUE(events[0].output.any_key);
+    TEST_ASSERT_TRUE(events[0].output.strobe);
+    TEST_ASSERT_EQUAL_UINT64(500, events[0].time_us);
+
+    TEST_ASSERT_FALSE(events[1].output.any_key);
+    TEST_ASSERT_FALSE(events[1].output.strobe);
+    TEST_ASSERT_EQUAL(0x00, events[1].output.key_code);
+    TEST_ASSERT_EQUAL_UINT64(100500, events[1].time_us);
+
+    TEST_ASSERT_TRUE(events[2].output.control);
+    TEST_ASSERT_EQUAL(0x07, events[2].output.key_code);
+    TEST_ASSERT_EQUAL_UINT64(100700, events[2].time_us);
+    TEST_ASSERT_FALSE(events[2].overflow);
+}
+
+// Test: Records without a key code change are two bytes
+void test_signal_monitor_compact_records(void)
+{
+    ay3600_output_t output = { .key_code = 0x03, .any_key = true, .strobe = true };
+
+    init_monitor();
+    signal_monitor_sink(&output, AY3600_PINS_ALL, &monitor);
+    size_t first = signal_monitor_pending(&monitor);
+    TEST_ASSERT_EQUAL(4 + 3, first);   // keyframe + flags, delta, code
+
+    fake_us += 50;
+    signal_monitor_sink(&output, AY3600_PIN_BIT(AY3600_PIN_KSTRB), &monitor);
+    TEST_ASSERT_EQUAL(first + 2, signal_monitor_pending(&monitor));
+}
+
+// Test: Periodic keyframes let a decoder join mid-stream
+void test_signal_monitor_join_mid_stream(void)
+{
+    ay3600_output_t output = { .key_code = 0x0A, .any_key = true, .strobe = true };
+
+    init_monitor();
+    for (int i = 0; i < SIGNAL_MONITOR_KEYFRAME_INTERVAL * 3; i++) {
+        fake_us += 50000;
+        signal_monitor_sink(&output, AY3600_PIN_BIT(AY3600_PIN_KSTRB), &monitor);
+        signal_monitor_flush(&monitor);
+    }
+
+    // Skip the first keyframe and start in the middle of a record
+    decode_captured(20);
+    TEST_ASSERT_TRUE(event_count >= SIGNAL_MONITOR_KEYFRAME_INTERVAL);
+    TEST_ASSERT_TRUE(event_count < SIGNAL_MONITOR_KEYFRAME_INTERVAL * 3);
+    TEST_ASSERT_EQUAL(0x0A, events[event_count - 1].output.key_code);
+}
+
+// Test: A full buffer drops records and flags the gap
+void test_signal_monitor_overflow(void)
+{
+    ay3600_output_t output = { .key_code = 0x11, .any_key = true, .strobe = true };
+    signal_monitor_stats_t stats;
+
+    init_monitor();
+    write_limit = 0;
+    for (int i = 0; i < SIGNAL_MONITOR_BUFFER_SIZE; i++) {
+        fake_us += 10;
+        signal_monitor_sink(&output, AY3600_PIN_BIT(AY3600_PIN_KSTRB), &monitor);
+        signal_monitor_flush(&monitor);
+    }
+
+    signal_monitor_get_stats(&monitor, &stats);
+    TEST_ASSERT_TRUE(stats.dropped > 0);
+    TEST_ASSERT_EQUAL(SIGNAL_MONITOR_BUFFER_SIZE, stats.records + stats.dropped);
+
+    write_limit = SIZE_MAX;
+    signal_monitor_flush(&monitor);
+    fake_us += 10;
+    output.key_code = 0x12;
+    signal_monitor_sink(&output, AY3600_PINS_ALL, &monitor);
+    signal_monitor_flush(&monitor);
+
+    decode_captured(0);
+    TEST_ASSERT_EQUAL(stats.records + 1, event_count);
+    TEST_ASSERT_TRUE(events[event_count - 1].overflow);
+    TEST_ASSERT_EQUAL(0x12, events[event_count - 1].output.key_code);
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)SIGNAL_MONITOR_BUFFER_SIZE * 10 + 10,
+                             events[event_count - 1].time_us);
+}
+
+// Test: Decoder rejects garbage and recovers at the next keyframe
+void test_signal_monitor_decoder_resync(void)
+{
+    static const uint8_t stream[] = {
+        0x10, 0x05, 0x03,                   // record before any keyframe
+        0xFF, 'A', 'Y', SIGNAL_MONITOR_VERSION,
+        0x04, 0x05,                         // no code after keyframe: error
+        0xFF, 'A', 'Y', SIGNAL_MONITOR_VERSION,
+        0x1C, 0x0A, 0x09,                   // ANY-KEY, strobe, code 9
+        0x40,                               // reserved bits: error
+        0xFF, 0xFF, 'A', 'Y', SIGNAL_MONITOR_VERSION,
+        0x10, 0x02, 0x00,                   // release
+    };
+    signal_monitor_decoder_t decoder;
+    signal_monitor_event_t out[4];
+    int n = 0;
+
+    signal_monitor_decoder_init(&decoder);
+    for (size_t i = 0; i < sizeof(stream); i++) {
+        if (signal_monitor_decode(&decoder, stream[i], &out[n])) {
+            n++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(2, n);
+    TEST_ASSERT_EQUAL(2, decoder.errors);
+    TEST_ASSERT_EQUAL(0x09, out[0].output.key_code);
+    TEST_ASSERT_TRUE(out[0].output.strobe);
+    TEST_ASSERT_FALSE(out[1].output.any_key);
+    TEST_ASSERT_EQUAL_UINT64(0x0A + 0x02 + 0x05, out[1].time_us);
+}
+
+// Test: Stream flows through a non-blocking pipe
+void test_signal_monitor_pipe(void)
+{
+    int fds[2];
+    uint8_t rx[256];
+    signal_monitor_config_t config = {
+        .write = signal_monitor_fd_write,
+        .clock_us = fake_clock,
+    };
+
+    TEST_ASSERT_EQUAL(0, pipe(fds));
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    config.write_ctx = (void *)(intptr_t)fds[1];
+    TEST_ASSERT_EQUAL(0, signal_monitor_init(&monitor, &config));
+    TEST_ASSERT_EQUAL(0, ay3600_add_sink(signal_monitor_sink, AY3600_PINS_ALL, &monitor));
+
+    ay3600_press_key(0x15, false, false);
+    ay3600_release_key();
+    int sent = signal_monitor_flush(&monitor);
+    TEST_ASSERT_TRUE(sent > 0);
+
+    TEST_ASSERT_EQUAL(sent, (int)read(fds[0], rx, sizeof(rx)));
+    memcpy(captured, rx, (size_t)sent);
+    captured_len = (size_t)sent;
+    decode_captured(0);
+    TEST_ASSERT_EQUAL(2, event_count);
+    TEST_ASSERT_EQUAL(0x15, events[0].output.key_code);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+// Test: Encoding stays cheap enough for the GPIO path
+void test_signal_monitor_sink_cost(void)
+{
+    ay3600_output_t output = { .key_code = 0x04, .any_key = true, .strobe = true };
+    struct timespec start, end;
+    const int iterations = 1000000;
+    signal_monitor_config_t config = { .write = capture_write };
+
+    TEST_ASSERT_EQUAL(0, signal_monitor_init(&monitor, &config));
+    write_limit = SIZE_MAX;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        output.key_code = i & 0x1F;
+        signal_monitor_sink(&output, AY3600_PINS_ALL, &monitor);
+        if ((i & 63) == 63) {
+            captured_len = 0;
+            signal_monitor_flush(&monitor);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / iterations;
+    char msg[64];
+    snprintf(msg, sizeof(msg), "signal_monitor: %.1f ns per record (including flush)", ns);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(ns < 1000.0);
+    TEST_ASSERT_EQUAL(0, monitor.stats.dropped);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    // Sink registry tests
+    RUN_TEST(test_sink_changed_mask);
+    RUN_TEST(test_sink_pin_mask_filter);
+    RUN_TEST(test_sink_no_change_skipped);
+    RUN_TEST(test_sink_registry);
+
+    // Signal monitor tests
+    RUN_TEST(test_signal_monitor_round_trip);
+    RUN_TEST(test_signal_monitor_compact_records);
+    RUN_TEST(test_signal_monitor_join_mid_stream);
+    RUN_TEST(test_signal_monitor_overflow);
+    RUN_TEST(test_signal_monitor_decoder_resync);
+    RUN_TEST(test_signal_monitor_pipe);
+    RUN_TEST(test_signal_monitor_sink_cost);
+
+    return UNITY_END();
+}
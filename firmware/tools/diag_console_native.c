@@ -0,0 +1,89 @@
+/**
+ * @file diag_console_native.c
+ * @brief Run the diagnostics console over stdin on the host
+ *
+ * Runs the emulator main loop on a 1 ms thread, as on the device, and the
+ * diagnostics console on the main thread at a lower priority.
+ *
+ * Build: gcc -DNATIVE_TEST -Isrc tools/diag_console_native.c src/[!m]*.c \
+ *            -lpthread -o diag_console
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "ay3600_emulator.h"
+#include "key_injector.h"
+#include "diag_console.h"
+
+static diag_console_t console;
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static void console_write(void *ctx, const char *text, size_t len)
+{
+    (void)ctx;
+    fwrite(text, 1, len, stdout);
+    fflush(stdout);
+}
+
+/**
+ * @brief Emulator main loop, mirroring app_main()
+ */
+static void *emulator_thread(void *arg)
+{
+    const struct timespec tick = { 0, 1000000 };
+
+    (void)arg;
+    while (1) {
+        key_injector_process(now_ms());
+        ay3600_process();
+        diag_console_apply(&console);
+        nanosleep(&tick, NULL);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    ay3600_config_t config = {
+        .debounce_ms = 20,
+        .repeat_delay_ms = 500,
+        .repeat_rate_ms = 50,
+    };
+    key_injector_config_t injector_config = {
+        .hold_ms = config.debounce_ms + 20,
+        .gap_ms = 10,
+    };
+    diag_console_config_t console_config = {
+        .write = console_write,
+    };
+    pthread_t thread;
+    char buffer[64];
+    ssize_t n;
+
+    ay3600_init(&config);
+    key_injector_init(&injector_config);
+    diag_console_init(&console, &console_config);
+
+    if (pthread_create(&thread, NULL, emulator_thread, NULL) != 0) {
+        perror("pthread_create");
+        return 1;
+    }
+
+    // Lower the console thread only; the emulator thread keeps its priority
+    if (nice(10) == -1) {
+        perror("nice");
+    }
+
+    while ((n = read(STDIN_FILENO, buffer, sizeof(buffer))) > 0) {
+        diag_console_feed(&console, buffer, (size_t)n);
+    }
+    return 0;
+}
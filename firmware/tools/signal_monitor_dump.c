@@ -0,0 +1,52 @@
+/**
+ * @file signal_monitor_dump.c
+ * @brief Host decoder for the signal monitor stream
+ *
+ * Reads a signal monitor stream from a file, pipe or serial device (stdin
+ * by default) and prints one line per output transition.
+ *
+ * Build: gcc -DNATIVE_TEST -Isrc tools/signal_monitor_dump.c src/signal_monitor.c
+ */
+
+#include <stdio.h>
+#include "signal_monitor.h"
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    signal_monitor_decoder_t decoder;
+    signal_monitor_event_t event;
+    uint64_t last_strobe_us = 0;
+    int c;
+
+    if (argc > 1 && !(in = fopen(argv[1], "rb"))) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    signal_monitor_decoder_init(&decoder);
+    while ((c = fgetc(in)) != EOF) {
+        if (!signal_monitor_decode(&decoder, (uint8_t)c, &event)) {
+            continue;
+        }
+
+        printf("%12.3f ms  %s code=0x%02X%s%s%s",
+               event.time_us / 1000.0,
+               event.output.any_key ? "KEY" : "---",
+               event.output.key_code,
+               event.output.control ? " CTRL" : "",
+               event.output.shift ? " SHIFT" : "",
+               event.output.strobe ? " KSTRB" : "");
+        if (event.output.strobe) {
+            printf("  (+%.3f ms)", (event.time_us - last_strobe_us) / 1000.0);
+            last_strobe_us = event.time_us;
+        }
+        printf("%s\n", event.overflow ? "  [transitions lost]" : "");
+        fflush(stdout);
+    }
+
+    if (decoder.errors) {
+        fprintf(stderr, "%lu malformed records skipped\n", (unsigned long)decoder.errors);
+    }
+    return 0;
+}